@@ -0,0 +1,287 @@
+#ifndef COMMON_BASE_ASYNC_LRU_CACHE_H
+#define COMMON_BASE_ASYNC_LRU_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "lockfree_circular_queue.h"
+#include "lru_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// LRU_cache的异步前端
+/// \details 调用线程将get/put命令提交到无锁命令队列后立即返回，由专用的缓存线程批量执行，
+///          结果通过回调或future返回；提交时不获取容器的锁，容器被长时间占用（大量淘汰、拷贝）时也不会阻塞调用线程；
+///          需要同步结果又不能等待时可使用try_get
+/// \param [QueueSize] 命令队列容量，需为2的幂
+/// \warning 回调在缓存线程中执行，应尽快返回，且不能同步等待本对象的其他命令
+///
+template <typename Key, typename Value, size_t QueueSize = 1024>
+class async_lru_cache
+{
+public:
+    using key_type          = Key;
+    using value_type        = Value;
+    using cache_type        = LRU_cache<Key, Value>;
+    using value_ptr_type    = typename cache_type::value_ptr_type;
+    using size_type         = size_t;
+
+    /// get的回调，found为false时value为nullptr
+    using get_callback      = std::function<void(bool found, const value_ptr_type& value)>;
+    /// put完成后的回调
+    using put_callback      = std::function<void()>;
+
+private:
+    static const size_type  kSpinCount = 64;
+
+    struct command {
+        bool            m_put;
+        key_type        m_key;
+        value_ptr_type  m_value;
+        get_callback    m_on_get;
+        put_callback    m_on_put;
+    };
+
+    cache_type                                      m_cache;
+    lockfree_circular_queue<command, QueueSize>     m_commands;
+    size_type                                       m_max_batch;
+
+    std::thread                                     m_thread;
+    std::mutex                                      m_thread_mutex;
+    std::condition_variable                         m_thread_cond;
+    std::atomic<bool>                               m_sleeping;     // 缓存线程是否在等待新命令
+    std::atomic<bool>                               m_closed;
+    std::atomic<size_type>                          m_submitting;   // 已通过关闭检查、尚未入队的提交个数
+    bool                                            m_running;
+
+public:
+    async_lru_cache() = delete;
+    async_lru_cache(const async_lru_cache&) = delete;
+    async_lru_cache& operator=(const async_lru_cache&) = delete;
+
+    ///
+    /// construct
+    /// \param [Size] 最大元素个数，[MemorySize] 最大内存大小（以字节为单位，为0时不限制），
+    ///        [MaxBatch] 缓存线程每次唤醒后最多连续执行的命令个数
+    /// \details 构造后即启动缓存线程
+    ///
+    async_lru_cache(size_type Size, size_type MemorySize = 0, size_type MaxBatch = 64) :
+        m_cache(Size, MemorySize),
+        m_max_batch(MaxBatch == 0 ? 1 : MaxBatch),
+        m_sleeping(false),
+        m_closed(false),
+        m_submitting(0),
+        m_running(true)
+    {
+        m_thread = std::thread(&async_lru_cache::_run, this);
+    }
+
+    ~async_lru_cache()
+    {
+        close();
+    }
+
+public:
+    ///
+    /// try_get
+    /// \brief 同步查找，容器被占用时立即返回，见LRU_cache::try_get
+    ///
+    bool try_get(const key_type& key, value_ptr_type& value, bool& busy)
+    {
+        return m_cache.try_get(key, value, busy);
+    }
+
+    ///
+    /// async_get
+    /// \brief 提交get命令，结果通过callback返回
+    /// \return bool [true]: 提交成功 [false]: 命令队列已满或已关闭，callback不会被调用
+    ///
+    bool async_get(const key_type& key, const get_callback& callback)
+    {
+        return _submit(command{false, key, nullptr, callback, nullptr});
+    }
+
+    ///
+    /// async_get
+    /// \brief 提交get命令，结果通过future返回，未命中时为nullptr
+    /// \return bool 同上，返回false时result无效（valid()为false）
+    ///
+    bool async_get(const key_type& key, std::future<value_ptr_type>& result)
+    {
+        auto promise = std::make_shared<std::promise<value_ptr_type>>();
+        result = promise->get_future();
+        if (!async_get(key, [promise](bool, const value_ptr_type& value) { promise->set_value(value); })) {
+            result = std::future<value_ptr_type>();
+            return false;
+        }
+        return true;
+    }
+
+    ///
+    /// async_put
+    /// \brief 提交push命令，完成后调用callback（可为nullptr）
+    /// \return bool [true]: 提交成功 [false]: 命令队列已满或已关闭
+    ///
+    bool async_put(const key_type& key, const value_ptr_type& value, const put_callback& callback = nullptr)
+    {
+        return _submit(command{true, key, value, nullptr, callback});
+    }
+
+    ///
+    /// async_put
+    /// \brief 提交push命令，完成后future就绪
+    /// \return bool 同上，返回false时result无效（valid()为false）
+    ///
+    bool async_put(const key_type& key, const value_ptr_type& value, std::future<void>& result)
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        result = promise->get_future();
+        if (!async_put(key, value, [promise]() { promise->set_value(); })) {
+            result = std::future<void>();
+            return false;
+        }
+        return true;
+    }
+
+    ///
+    /// close
+    /// \brief 执行完已提交的命令后停止缓存线程，之后提交的命令均失败
+    /// \details 与close并发的提交要么返回false，要么在close返回前被执行
+    ///
+    void close();
+
+    ///
+    /// pending
+    /// \return size_type 尚未执行的命令个数（近似值）
+    ///
+    size_type pending() const
+    {
+        return m_commands.size();
+    }
+
+    ///
+    /// cache
+    /// \brief 内部的LRU_cache，可在不在意阻塞的线程中直接调用，或获取统计信息
+    ///
+    cache_type& cache()
+    {
+        return m_cache;
+    }
+
+private:
+    bool _submit(command&& cmd)
+    {
+        // 先登记再检查是否已关闭，close设置m_closed后等待登记清零，二者之一必然看到对方
+        m_submitting.fetch_add(1, std::memory_order_seq_cst);
+        bool ok = !m_closed.load(std::memory_order_seq_cst) && m_commands.try_push(std::move(cmd));
+        m_submitting.fetch_sub(1, std::memory_order_release);
+        if (!ok) {
+            return false;
+        }
+        // 只有缓存线程等待时才需要唤醒，此时缓存线程只在检查队列与开始等待之间短暂持有m_thread_mutex
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            { std::lock_guard<std::mutex> lck (m_thread_mutex); }
+            m_thread_cond.notify_one();
+        }
+        return true;
+    }
+
+    ///
+    /// [内部方法] 执行至多m_max_batch个命令
+    /// \return size_type 执行的命令个数
+    ///
+    size_type _execute_batch();
+
+    void _run();
+};
+
+template <typename Key, typename Value, size_t QueueSize>
+void async_lru_cache<Key, Value, QueueSize>::close()
+{
+    m_closed.store(true, std::memory_order_seq_cst);
+    // 等待已通过检查的提交入队，之后队列中不会再出现新的命令
+    while (m_submitting.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lck (m_thread_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_thread_cond.notify_all();
+    m_thread.join();
+
+    // 执行关闭前已提交的命令
+    while (_execute_batch() != 0) {
+    }
+}
+
+template <typename Key, typename Value, size_t QueueSize>
+typename async_lru_cache<Key, Value, QueueSize>::size_type
+async_lru_cache<Key, Value, QueueSize>::_execute_batch()
+{
+    size_type count = 0;
+    while (count < m_max_batch) {
+        command cmd;
+        if (!m_commands.try_pop(cmd)) {
+            break;
+        }
+        ++count;
+        if (cmd.m_put) {
+            m_cache.push(cmd.m_key, cmd.m_value);
+            if (cmd.m_on_put) {
+                cmd.m_on_put();
+            }
+        } else {
+            value_ptr_type value;
+            bool found = m_cache.get(cmd.m_key, value);
+            if (cmd.m_on_get) {
+                cmd.m_on_get(found, found ? value : nullptr);
+            }
+        }
+    }
+    return count;
+}
+
+template <typename Key, typename Value, size_t QueueSize>
+void async_lru_cache<Key, Value, QueueSize>::_run()
+{
+    std::unique_lock<std::mutex> lck (m_thread_mutex);
+    while (m_running) {
+        lck.unlock();
+        // 队列为空后先让出CPU若干次再等待，命令连续到达时避免每次都需要唤醒
+        for (size_type idle = 0; idle < kSpinCount; ) {
+            if (_execute_batch() == 0) {
+                ++idle;
+                std::this_thread::yield();
+            } else {
+                idle = 0;
+            }
+        }
+        lck.lock();
+
+        // 先声明将要等待，再检查队列，与_submit配合避免丢失唤醒
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_commands.empty() && m_running) {
+            m_thread_cond.wait(lck);
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef COMMON_BASE_BLOOM_FILTER_H
+#define COMMON_BASE_BLOOM_FILTER_H
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace tinycommon {
+namespace base {
+
+///
+/// [内部方法] 计算bloom filter的槽位数与hash函数个数
+/// \param [in]: expected 预期元素个数, fp_rate 期望的误判率, [out]: slots 槽位数, hashes hash函数个数
+///
+inline void bloom_filter_params(size_t expected, double fp_rate, size_t& slots, size_t& hashes)
+{
+    if (expected == 0) {
+        expected = 1;
+    }
+    if (!(fp_rate > 0.0 && fp_rate < 1.0)) {
+        fp_rate = 0.01;
+    }
+
+    const double ln2 = std::log(2.0);
+    double m = -static_cast<double>(expected) * std::log(fp_rate) / (ln2 * ln2);
+    slots = m < 64.0 ? 64 : static_cast<size_t>(std::ceil(m));
+
+    double k = m / static_cast<double>(expected) * ln2;
+    hashes = k < 1.0 ? 1 : static_cast<size_t>(std::lround(k));
+    if (hashes > 16) {
+        hashes = 16;
+    }
+}
+
+///
+/// [内部方法] 64位混淆（splitmix64），std::hash对整数通常为恒等映射，需要打散
+///
+inline uint64_t bloom_filter_mix(uint64_t h)
+{
+    h += 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+///
+/// 计数bloom filter，支持删除
+/// \details 所有操作均为无锁的原子操作，可在不持有外部锁的情况下调用may_contain；
+///          计数器为8位，饱和（达到255）后不再增减，只会增加误判，不会漏判；
+///          采用分块布局：一个key的所有计数器位于同一个64字节的块（cache line）内，查询只有一次cache miss
+/// \warning remove只能用于之前add过的元素，否则可能导致漏判
+///
+template <typename Key, typename Hash = std::hash<Key>>
+class counting_bloom_filter
+{
+public:
+    using key_type      = Key;
+    using size_type     = size_t;
+    using counter_type  = std::atomic<uint8_t>;
+
+private:
+    static const uint8_t    kSaturated = 0xff;
+    static const size_type  kBlockSize = 64;        // 每块的计数器个数，即一个cache line
+
+    std::unique_ptr<counter_type[]>     m_buffer;
+    counter_type*                       m_counters; // m_buffer中按cache line对齐的起始位置
+    size_type                           m_slots;    // 计数器个数
+    size_type                           m_blocks;   // 块个数
+    size_type                           m_hashes;   // hash函数个数
+    Hash                                m_hash;
+
+public:
+    counting_bloom_filter() = delete;
+
+    ///
+    /// construct
+    /// \param [Expected] 预期元素个数，[FalsePositiveRate] 期望的误判率
+    ///
+    counting_bloom_filter(size_type Expected, double FalsePositiveRate = 0.01)
+    {
+        // 分块后误判率略有上升，槽位数多分配1/4作为补偿
+        bloom_filter_params(Expected, FalsePositiveRate, m_slots, m_hashes);
+        m_blocks = (m_slots + m_slots / 4 + kBlockSize - 1) / kBlockSize;
+        _allocate();
+        clear();
+    }
+
+    counting_bloom_filter(const counting_bloom_filter& from) :
+        m_slots(from.m_slots),
+        m_blocks(from.m_blocks),
+        m_hashes(from.m_hashes),
+        m_hash(from.m_hash)
+    {
+        _allocate();
+        for (size_type i = 0; i < m_slots; ++i) {
+            m_counters[i].store(from.m_counters[i].load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+        }
+    }
+
+    counting_bloom_filter& operator=(const counting_bloom_filter&) = delete;
+
+public:
+    ///
+    /// assign
+    /// \brief 原地复制另一个过滤器的计数，不重新分配内存
+    /// \param from 源过滤器
+    /// \return 两者的槽数、块数与哈希个数一致时复制并返回true，否则返回false
+    /// \details 逐个计数器复制，并发的may_contain只会看到新旧计数的混合，
+    ///          同时存在于新旧集合中的元素不会被误判为不存在
+    ///
+    bool assign(const counting_bloom_filter& from)
+    {
+        if (m_slots != from.m_slots || m_blocks != from.m_blocks ||
+            m_hashes != from.m_hashes) {
+            return false;
+        }
+        for (size_type i = 0; i < m_slots; ++i) {
+            m_counters[i].store(from.m_counters[i].load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    ///
+    /// add
+    /// \brief 添加元素
+    ///
+    void add(const key_type& key)
+    {
+        uint64_t h1, h2;
+        _hash(key, h1, h2);
+        for (size_type i = 0; i < m_hashes; ++i) {
+            counter_type& c = m_counters[_slot(h1, h2, i)];
+            uint8_t cur = c.load(std::memory_order_relaxed);
+            while (cur != kSaturated &&
+                   !c.compare_exchange_weak(cur, static_cast<uint8_t>(cur + 1), std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    ///
+    /// remove
+    /// \brief 删除之前添加过的元素
+    ///
+    void remove(const key_type& key)
+    {
+        uint64_t h1, h2;
+        _hash(key, h1, h2);
+        for (size_type i = 0; i < m_hashes; ++i) {
+            counter_type& c = m_counters[_slot(h1, h2, i)];
+            uint8_t cur = c.load(std::memory_order_relaxed);
+            while (cur != kSaturated && cur != 0 &&
+                   !c.compare_exchange_weak(cur, static_cast<uint8_t>(cur - 1), std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    ///
+    /// may_contain
+    /// \brief 判断元素是否可能存在
+    /// \return bool [true]: 可能存在（有一定误判率） [false]: 一定不存在
+    ///
+    bool may_contain(const key_type& key) const
+    {
+        uint64_t h1, h2;
+        _hash(key, h1, h2);
+        for (size_type i = 0; i < m_hashes; ++i) {
+            if (m_counters[_slot(h1, h2, i)].load(std::memory_order_relaxed) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ///
+    /// clear
+    /// \brief 清空所有计数器
+    ///
+    void clear()
+    {
+        for (size_type i = 0; i < m_slots; ++i) {
+            m_counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_type slots() const
+    {
+        return m_slots;
+    }
+
+    size_type hashes() const
+    {
+        return m_hashes;
+    }
+
+private:
+    void _allocate()
+    {
+        m_slots = m_blocks * kBlockSize;
+        m_buffer.reset(new counter_type[m_slots + kBlockSize]);
+        uintptr_t addr = reinterpret_cast<uintptr_t>(m_buffer.get());
+        m_counters = m_buffer.get() + (kBlockSize - addr % kBlockSize) % kBlockSize;
+    }
+
+    ///
+    /// [内部方法] h1确定所在块的起始下标，h2为块内偏移的种子
+    ///
+    void _hash(const key_type& key, uint64_t& h1, uint64_t& h2) const
+    {
+        uint64_t h = bloom_filter_mix(static_cast<uint64_t>(m_hash(key)));
+        h1 = static_cast<uint64_t>(_block(h)) * kBlockSize;
+        h2 = bloom_filter_mix(h);
+    }
+
+    size_type _block(uint64_t h) const
+    {
+        // 取高32位乘法映射到[0, m_blocks)，避免取模
+        return static_cast<size_type>(((h >> 32) * static_cast<uint64_t>(m_blocks)) >> 32);
+    }
+
+    size_type _slot(uint64_t h1, uint64_t h2, size_type i) const
+    {
+        // 块内偏移：h2每6位对应一个计数器，64位可提供10个，超出部分用double hashing补充
+        uint64_t offset = i < 10 ? (h2 >> (6 * i)) : ((h2 >> 32) + i * (h2 | 1));
+        return static_cast<size_type>(h1 + (offset & (kBlockSize - 1)));
+    }
+};
+
+///
+/// 分代轮换的bloom filter，用于记录已知不存在于后端的key（negative cache）
+/// \details 维护current与previous两代，insert写入current，may_contain同时查询两代；
+///          current写满（插入次数达到Expected）或调用rotate时，清空previous并将其作为新的current，
+///          因此每个key至少保留一代、至多保留两代，实现按插入量老化
+///          insert与may_contain均为无锁操作，rotate之间通过互斥锁串行
+/// \warning 后端新增了某个key后，此filter仍可能在老化前报告其不存在；
+///          调用方应先查询缓存，并在向后端写入后将key压入缓存
+///
+template <typename Key, typename Hash = std::hash<Key>>
+class rotating_bloom_filter
+{
+public:
+    using key_type      = Key;
+    using size_type     = size_t;
+    using word_type     = std::atomic<uint64_t>;
+
+private:
+    std::unique_ptr<word_type[]>    m_bits[2];
+    size_type                       m_words;        // 每代的64位字个数
+    size_type                       m_slots;        // 每代的位数
+    size_type                       m_hashes;       // hash函数个数
+    size_type                       m_expected;     // 每代的预期元素个数
+    Hash                            m_hash;
+
+    std::atomic<size_type>          m_current;      // current的下标
+    std::atomic<size_type>          m_inserted;     // current已插入的次数
+    std::atomic<size_type>          m_rotations;    // 已轮换次数
+    std::mutex                      m_rotate_mutex;
+
+public:
+    rotating_bloom_filter() = delete;
+    rotating_bloom_filter(const rotating_bloom_filter&) = delete;
+    rotating_bloom_filter& operator=(const rotating_bloom_filter&) = delete;
+
+    ///
+    /// construct
+    /// \param [Expected] 每代预期元素个数，[FalsePositiveRate] 每代期望的误判率
+    ///
+    rotating_bloom_filter(size_type Expected, double FalsePositiveRate = 0.01) :
+        m_expected(Expected == 0 ? 1 : Expected),
+        m_current(0),
+        m_inserted(0),
+        m_rotations(0)
+    {
+        bloom_filter_params(Expected, FalsePositiveRate, m_slots, m_hashes);
+        m_words = (m_slots + 63) / 64;
+        m_slots = m_words * 64;
+        for (int g = 0; g < 2; ++g) {
+            m_bits[g].reset(new word_type[m_words]);
+            _clear(g);
+        }
+    }
+
+public:
+    ///
+    /// insert
+    /// \brief 记录key，current写满时自动轮换
+    ///
+    void insert(const key_type& key)
+    {
+        uint64_t h1, h2;
+        _hash(key, h1, h2);
+
+        word_type* bits = m_bits[m_current.load(std::memory_order_acquire)].get();
+        for (size_type i = 0; i < m_hashes; ++i) {
+            size_type slot = _slot(h1, h2, i);
+            bits[slot / 64].fetch_or(1ULL << (slot % 64), std::memory_order_relaxed);
+        }
+
+        if (m_inserted.fetch_add(1, std::memory_order_relaxed) + 1 >= m_expected) {
+            _rotate(m_rotations.load(std::memory_order_relaxed));
+        }
+    }
+
+    ///
+    /// may_contain
+    /// \brief 判断key是否可能被记录过
+    /// \return bool [true]: 可能被记录过 [false]: 未被记录或已老化
+    ///
+    bool may_contain(const key_type& key) const
+    {
+        uint64_t h1, h2;
+        _hash(key, h1, h2);
+
+        size_type current = m_current.load(std::memory_order_acquire);
+        return _test(current, h1, h2) || _test(1 - current, h1, h2);
+    }
+
+    ///
+    /// rotate
+    /// \brief 手动轮换：丢弃previous，current成为previous，可用于按时间老化
+    ///
+    void rotate()
+    {
+        _rotate(m_rotations.load(std::memory_order_relaxed));
+    }
+
+    ///
+    /// clear
+    /// \brief 清空两代
+    ///
+    void clear()
+    {
+        std::lock_guard<std::mutex> lck (m_rotate_mutex);
+        _clear(0);
+        _clear(1);
+        m_inserted.store(0, std::memory_order_relaxed);
+    }
+
+    size_type rotations() const
+    {
+        return m_rotations.load(std::memory_order_relaxed);
+    }
+
+private:
+    ///
+    /// [内部方法] 轮换，observed为调用方观察到的轮换次数，
+    ///            多个线程同时触发自动轮换时只有一个生效
+    ///
+    void _rotate(size_type observed)
+    {
+        std::lock_guard<std::mutex> lck (m_rotate_mutex);
+        if (m_rotations.load(std::memory_order_relaxed) != observed) {
+            return;
+        }
+
+        size_type next = 1 - m_current.load(std::memory_order_relaxed);
+        // 先清空再切换：清空过程中并发的may_contain最多漏判，不会误判
+        _clear(next);
+        m_inserted.store(0, std::memory_order_relaxed);
+        m_current.store(next, std::memory_order_release);
+        m_rotations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void _clear(size_type generation)
+    {
+        word_type* bits = m_bits[generation].get();
+        for (size_type i = 0; i < m_words; ++i) {
+            bits[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool _test(size_type generation, uint64_t h1, uint64_t h2) const
+    {
+        const word_type* bits = m_bits[generation].get();
+        for (size_type i = 0; i < m_hashes; ++i) {
+            size_type slot = _slot(h1, h2, i);
+            if ((bits[slot / 64].load(std::memory_order_relaxed) & (1ULL << (slot % 64))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _hash(const key_type& key, uint64_t& h1, uint64_t& h2) const
+    {
+        uint64_t h = bloom_filter_mix(static_cast<uint64_t>(m_hash(key)));
+        h1 = h;
+        h2 = bloom_filter_mix(h) | 1;
+    }
+
+    size_type _slot(uint64_t h1, uint64_t h2, size_type i) const
+    {
+        return static_cast<size_type>((h1 + i * h2) % m_slots);
+    }
+};
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,307 @@
+#ifndef COMMON_BASE_BROADCAST_RING_H
+#define COMMON_BASE_BROADCAST_RING_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 单生产者、多消费者的广播环状队列（Disruptor风格）
+/// \details 生产者每个对象只写入一次，每个消费者持有独立的读游标，都能读到全部对象；
+///          消费者可一次批量读取所有可读对象，批量读取只在结束时更新一次游标
+/// \param [T] 对象类型，[BufSize] 队列容量，
+///        [Overwrite] [false]: 队列满（最慢的消费者落后BufSize个）时生产者等待；
+///                    [true]: 与circular_queue::push_back相同，覆盖最旧的对象，落后过多的消费者跳过被覆盖的对象
+/// \warning push_back只能在一个线程中调用；每个消费者编号同一时刻只能在一个线程中读取
+///
+template<typename T, size_t BufSize = 1, bool Overwrite = false>
+class broadcast_ring {
+public:
+    using value_type        = T;
+    using size_type         = size_t;
+    using sequence_type     = uint64_t;
+
+    // 覆盖模式下消费者读取时对象可能正被覆盖，对象按原子字逐字拷贝，读取后再校验是否有效（seqlock），
+    // 要求T可按字节拷贝
+    static_assert(!Overwrite || std::is_trivially_copyable<T>::value,
+                  "broadcast_ring in overwrite mode requires a trivially copyable T");
+    static_assert(BufSize > 0, "broadcast_ring requires BufSize > 0");
+
+private:
+    static const size_type  kCacheLine = 64;
+
+    using word_type         = uintptr_t;
+    static const size_type  kSlotWords = (sizeof(value_type) + sizeof(word_type) - 1) / sizeof(word_type);
+
+    /// 独占一个cache line的序号，避免生产者与各消费者之间的伪共享
+    struct padded_sequence {
+        std::atomic<sequence_type>  m_value;
+        std::atomic<sequence_type>  m_skipped;  // 覆盖模式下消费者跳过的对象总数
+        char                        m_pad[kCacheLine - 2 * sizeof(std::atomic<sequence_type>)];
+    };
+    static_assert(sizeof(padded_sequence) == kCacheLine, "padded_sequence must fill one cache line");
+    static_assert(std::is_trivially_destructible<padded_sequence>::value,
+                  "padded_sequence is constructed in raw memory and never destroyed explicitly");
+
+    std::unique_ptr<value_type[]>       m_buffer;       // 非覆盖模式下的对象
+    std::unique_ptr<std::atomic<word_type>[]> m_words;  // 覆盖模式下的对象，每个占kSlotWords个原子字
+
+    std::unique_ptr<char[]>             m_cursor_buffer;    // 多分配一个cache line，用于对齐
+    padded_sequence*                    m_cursors;      // 各消费者下一个要读取的序号，在m_cursor_buffer中按cache line对齐构造
+    size_type                           m_consumers;    // 消费者个数
+
+    char                                m_pad0[kCacheLine];
+    padded_sequence                     m_published;    // 已发布的对象个数，即下一个要写入的序号
+    padded_sequence                     m_claim;        // 覆盖模式下正在写入的序号 + 1
+
+    // 以下只由生产者访问
+    sequence_type                       m_next;         // 下一个要写入的序号
+    sequence_type                       m_gating;       // 缓存的最慢消费者游标，减少扫描全部游标的次数
+    char                                m_pad1[kCacheLine];
+
+public:
+    broadcast_ring() = delete;
+    broadcast_ring(const broadcast_ring&) = delete;
+    broadcast_ring& operator=(const broadcast_ring&) = delete;
+
+    ///
+    /// construct
+    /// \param [Consumers] 消费者个数，消费者编号为[0, Consumers)
+    ///
+    explicit broadcast_ring(size_type Consumers);
+
+public:
+    ///
+    /// capacity
+    /// \return size_type 队列容量
+    ///
+    size_type capacity() const {
+        return BufSize;
+    }
+
+    ///
+    /// consumers
+    /// \return size_type 消费者个数
+    ///
+    size_type consumers() const {
+        return m_consumers;
+    }
+
+    ///
+    /// size
+    /// \brief 消费者consumer尚未读取的对象个数
+    /// \return size_type 覆盖模式下不超过BufSize
+    ///
+    size_type size(size_type consumer) const {
+        assert(consumer < m_consumers);
+        sequence_type published = m_published.m_value.load(std::memory_order_acquire);
+        sequence_type cursor = m_cursors[consumer].m_value.load(std::memory_order_acquire);
+        sequence_type n = published - cursor;
+        return static_cast<size_type>(n > BufSize ? BufSize : n);
+    }
+
+    ///
+    /// push_back
+    /// \brief 向队列尾部追加对象
+    /// \param from
+    /// @warning 非覆盖模式下，队列满时等待最慢的消费者读取；覆盖模式下覆盖最旧的对象
+    ///
+    void push_back(const value_type& from) {
+        while (!try_push_back(from)) {
+            std::this_thread::yield();
+        }
+    }
+
+    ///
+    /// try_push_back
+    /// \brief 向队列尾部追加对象，不等待
+    /// \return bool [true]: 追加成功 [false]: 非覆盖模式下队列已满
+    ///
+    bool try_push_back(const value_type& from);
+
+    ///
+    /// pop
+    /// \brief 消费者consumer读取一个对象
+    /// \param [in]: consumer 消费者编号, [out]: to
+    /// \return bool [true]: 读取成功 [false]: 没有可读对象
+    ///
+    bool pop(size_type consumer, value_type& to) {
+        size_type n = consume(consumer, [&to](const value_type& v) { to = v; }, 1);
+        return n == 1;
+    }
+
+    ///
+    /// consume
+    /// \brief 消费者consumer批量读取当前所有可读对象（至多MaxCount个）
+    /// \param [in]: consumer 消费者编号, handler 对每个对象调用handler(const T&), MaxCount
+    /// \return size_type 读取的对象个数
+    /// @details 非覆盖模式下handler直接访问队列中的对象，不拷贝；读取结束后才更新游标
+    ///
+    template<typename Handler>
+    size_type consume(size_type consumer, Handler handler, size_type MaxCount = BufSize);
+
+    ///
+    /// overrun
+    /// \brief 覆盖模式下消费者consumer因落后过多而跳过的对象总数
+    ///
+    sequence_type overrun(size_type consumer) const {
+        assert(consumer < m_consumers);
+        return m_cursors[consumer].m_skipped.load(std::memory_order_relaxed);
+    }
+
+private:
+    size_type _index(sequence_type seq) const {
+        return static_cast<size_type>(seq % BufSize);
+    }
+
+    /// \brief 覆盖模式下写入对象，逐字relaxed写入，与消费者的读取不构成数据竞争
+    void _store_slot(sequence_type seq, const value_type& from) {
+        word_type words[kSlotWords] = {};
+        std::memcpy(words, &from, sizeof(value_type));
+        std::atomic<word_type>* slot = &m_words[_index(seq) * kSlotWords];
+        for (size_type i = 0; i < kSlotWords; ++i) {
+            slot[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    /// \brief 覆盖模式下读取对象，结果可能已被覆盖，需由调用方校验
+    void _load_slot(sequence_type seq, value_type& to) const {
+        word_type words[kSlotWords];
+        const std::atomic<word_type>* slot = &m_words[_index(seq) * kSlotWords];
+        for (size_type i = 0; i < kSlotWords; ++i) {
+            words[i] = slot[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&to, words, sizeof(value_type));
+    }
+
+    /// \brief 扫描所有消费者游标，返回最小值
+    sequence_type _min_cursor() const {
+        sequence_type min = m_next;
+        for (size_type i = 0; i < m_consumers; ++i) {
+            sequence_type cursor = m_cursors[i].m_value.load(std::memory_order_acquire);
+            if (cursor < min) {
+                min = cursor;
+            }
+        }
+        return min;
+    }
+};
+
+template<typename T, size_t BufSize, bool Overwrite>
+broadcast_ring<T, BufSize, Overwrite>::broadcast_ring(size_type Consumers) :
+    m_buffer(Overwrite ? nullptr : new value_type[BufSize]),
+    m_words(Overwrite ? new std::atomic<word_type>[BufSize * kSlotWords]() : nullptr),
+    m_cursor_buffer(new char[(Consumers + 1) * sizeof(padded_sequence)]),
+    m_consumers(Consumers),
+    m_next(0),
+    m_gating(0) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(m_cursor_buffer.get());
+    size_type offset = (kCacheLine - addr % kCacheLine) % kCacheLine;
+    // 在对齐后的原始内存上构造，padded_sequence只含原子整数，析构为平凡的，随m_cursor_buffer一并释放
+    char* aligned = m_cursor_buffer.get() + offset;
+    m_cursors = reinterpret_cast<padded_sequence*>(aligned);
+
+    for (size_type i = 0; i < m_consumers; ++i) {
+        padded_sequence* cursor = new (aligned + i * sizeof(padded_sequence)) padded_sequence;
+        cursor->m_value.store(0, std::memory_order_relaxed);
+        cursor->m_skipped.store(0, std::memory_order_relaxed);
+    }
+    m_published.m_value.store(0, std::memory_order_relaxed);
+    m_claim.m_value.store(0, std::memory_order_relaxed);
+}
+
+template<typename T, size_t BufSize, bool Overwrite>
+bool broadcast_ring<T, BufSize, Overwrite>::try_push_back(const value_type& from) {
+    sequence_type seq = m_next;
+
+    if (Overwrite) {
+        // seqlock写端：先声明要覆盖的序号，消费者读取后据此判断对象是否已被覆盖
+        m_claim.m_value.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    } else if (seq - m_gating >= BufSize) {
+        // 只有缓存的最慢游标显示队列已满时，才重新扫描所有游标
+        m_gating = _min_cursor();
+        if (seq - m_gating >= BufSize) {
+            return false;
+        }
+    }
+
+    if (Overwrite) {
+        _store_slot(seq, from);
+    } else {
+        m_buffer[_index(seq)] = from;
+    }
+
+    m_next = seq + 1;
+    m_published.m_value.store(seq + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t BufSize, bool Overwrite>
+template<typename Handler>
+typename broadcast_ring<T, BufSize, Overwrite>::size_type
+broadcast_ring<T, BufSize, Overwrite>::consume(size_type consumer, Handler handler, size_type MaxCount) {
+    assert(consumer < m_consumers);
+
+    std::atomic<sequence_type>& cursor = m_cursors[consumer].m_value;
+    sequence_type cur = cursor.load(std::memory_order_relaxed);
+    sequence_type published = m_published.m_value.load(std::memory_order_acquire);
+
+    size_type count = 0;
+    if (!Overwrite) {
+        sequence_type end = published - cur > MaxCount ? cur + MaxCount : published;
+        for (; cur != end; ++cur, ++count) {
+            handler(m_buffer[_index(cur)]);
+        }
+    } else {
+        sequence_type skipped = 0;
+        while (cur != published && count < MaxCount) {
+            // 落后超过BufSize时，跳过已被覆盖的对象
+            if (published - cur > BufSize) {
+                skipped += published - BufSize - cur;
+                cur = published - BufSize;
+            }
+
+            value_type value;
+            _load_slot(cur, value);
+
+            // seqlock读端：拷贝后检查生产者是否已开始覆盖此对象；
+            // 正在写入的序号为claim - 1，占用的是序号claim - 1 - BufSize的位置
+            std::atomic_thread_fence(std::memory_order_acquire);
+            sequence_type claim = m_claim.m_value.load(std::memory_order_relaxed);
+            if (claim > cur + BufSize) {
+                skipped += claim - BufSize - cur;
+                cur = claim - BufSize;
+                published = m_published.m_value.load(std::memory_order_acquire);
+                continue;
+            }
+
+            handler(value);
+            ++cur;
+            ++count;
+        }
+
+        if (skipped != 0) {
+            m_cursors[consumer].m_skipped.fetch_add(skipped, std::memory_order_relaxed);
+            cursor.store(cur, std::memory_order_release);
+        }
+    }
+
+    if (count != 0) {
+        cursor.store(cur, std::memory_order_release);
+    }
+    return count;
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -2,6 +2,7 @@
 #define COMMON_BASE_CIRCULAR_QUEUE_H
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <mutex>
@@ -35,6 +36,8 @@ private:
     index_type          m_tail;         // newest
     bool                m_isEmpty;      // 标志缓冲区是否为空
 
+    std::atomic<size_type>  m_publishedSize;    // 在锁内发布的对象数量，供无锁读取
+
 public:
 
     /// Empty
@@ -77,10 +80,25 @@ public:
     /// \return size_t 当前队列中的对象数量
     ///
     size_type size() const {
-        index_type head, tail;
-        bool isEmpty;
-        buffer_ptr_type buffer = _get_buffer(head, tail, isEmpty);
-        return _get_size(head, tail, isEmpty);
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return _get_size(m_head, m_tail, m_isEmpty);
+    }
+
+    /// SizeRelaxed
+    /// \brief SizeRelaxed 返回最近一次push_back/pop之后的对象数量，不加锁
+    /// \return size_t 当前队列中的对象数量（近似值）
+    /// @details 用于监控等高频轮询，不与读写线程竞争锁
+    ///
+    size_type size_relaxed() const {
+        return m_publishedSize.load(std::memory_order_relaxed);
+    }
+
+    /// EmptyRelaxed
+    /// \brief EmptyRelaxed 最近一次push_back/pop之后队列是否为空，不加锁
+    /// \return bool [true]：队列为空 [false]：队列不为空（近似值）
+    ///
+    bool empty_relaxed() const {
+        return size_relaxed() == 0;
     }
 
     /// Capacity
@@ -121,6 +139,7 @@ public:
         m_isEmpty = isEmpty;
 
         m_capacity = from.m_capacity;
+        _publish_size();
 
         return *this;
     }
@@ -158,6 +177,11 @@ private:
         return m_buffer;
     }
 
+    /// \brief 在锁内发布当前对象数量
+    void _publish_size() {
+        m_publishedSize.store(_get_size(m_head, m_tail, m_isEmpty), std::memory_order_relaxed);
+    }
+
     size_type _get_size(const index_type& head, const index_type& tail, const bool& isEmpty) const {
         if (isEmpty == true) {
             return 0;
@@ -174,7 +198,8 @@ template<typename T, size_t BufSize>
 circular_queue<T, BufSize>::circular_queue():m_buffer(new buffer_type),
                                            m_capacity(BufSize),
                                            m_head(0),m_tail(0),
-                                           m_isEmpty(true) {
+                                           m_isEmpty(true),
+                                           m_publishedSize(0) {
 }
 
 template<typename T, size_t BufSize>
@@ -191,6 +216,7 @@ circular_queue<T, BufSize>::circular_queue(const circular_queue &from) {
     m_isEmpty = isEmpty;
 
     m_capacity = from.m_capacity;
+    _publish_size();
 }
 
 template<typename T, size_t BufSize>
@@ -217,6 +243,7 @@ void circular_queue<T, BufSize>::push_back(const reference from) {
     (*m_buffer)[m_tail] = from;
 
     m_isEmpty = false;
+    _publish_size();
 }
 
 template<typename T, size_t BufSize>
@@ -237,6 +264,7 @@ typename circular_queue<T,BufSize>::value_type circular_queue<T, BufSize>::pop()
         m_tail = m_head;
         m_isEmpty = true;
     }
+    _publish_size();
 
     return _at(preHead, m_buffer);
 }
@@ -0,0 +1,626 @@
+#ifndef COMMON_BASE_FILE_VICTIM_TIER_H
+#define COMMON_BASE_FILE_VICTIM_TIER_H
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "flat_hash_index.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 可按字节拷贝类型的编解码器
+/// \details 编解码器需提供：
+///          static void encode(const T& from, std::string& to);                 // 追加到to的末尾
+///          static bool decode(const char* data, size_t len, T& to);            // 数据不合法时返回false
+///
+template <typename T>
+struct pod_codec
+{
+    static_assert(std::is_trivially_copyable<T>::value, "pod_codec requires a trivially copyable T");
+
+    static void encode(const T& from, std::string& to)
+    {
+        to.append(reinterpret_cast<const char*>(&from), sizeof(T));
+    }
+
+    static bool decode(const char* data, size_t len, T& to)
+    {
+        if (len != sizeof(T)) {
+            return false;
+        }
+        memcpy(&to, data, sizeof(T));
+        return true;
+    }
+};
+
+///
+/// std::string的编解码器
+///
+struct string_codec
+{
+    static void encode(const std::string& from, std::string& to)
+    {
+        to.append(from);
+    }
+
+    static bool decode(const char* data, size_t len, std::string& to)
+    {
+        to.assign(data, len);
+        return true;
+    }
+};
+
+///
+/// 基于本地文件的二级（victim）缓存
+/// \details 数据以日志方式追加写入分段文件（segment），内存中只保存key到文件位置的索引；
+///          读取时在锁外通过pread读取，不阻塞写入；
+///          更新或删除的key在原分段中留下失效数据，有效数据比例过低的分段由compact重写后删除；
+///          文件总大小超过上限时删除最旧的分段，其中的数据直接丢弃
+/// \param [Key] key类型，[Value] value类型，[ValueCodec] value的编解码器，[KeyCodec] key的编解码器（用于压缩时判断数据是否有效）
+/// \warning 文件只在本对象的生命周期内有效，不支持重启后恢复；目录中同名的分段文件会被覆盖
+///
+template <typename Key, typename Value,
+          typename ValueCodec = pod_codec<Value>, typename KeyCodec = pod_codec<Key>>
+class file_victim_tier
+{
+public:
+    using key_type          = Key;
+    using value_type        = Value;
+    using size_type         = size_t;
+
+    struct Options {
+        size_type   m_segment_bytes;    // 单个分段文件的大小，超过后切换到新分段；小于kMinSegmentBytes时取kMinSegmentBytes
+        size_type   m_max_bytes;        // 所有分段文件的总大小上限，为0时不限制
+        double      m_compact_ratio;    // 有效数据比例低于此值的分段会被压缩
+    };
+
+    struct Stats {
+        size_type   m_get_cnt;          // get/take的次数
+        size_type   m_hit_cnt;          // 命中的次数
+        size_type   m_compact_cnt;      // 被压缩的分段个数
+        size_type   m_drop_cnt;         // 因超出总大小上限被删除的分段个数
+    };
+
+    static const size_type  kMinSegmentBytes = 1024;
+
+private:
+    using segment_id_type   = uint64_t;
+
+    /// 记录头，之后依次为key与value的编码
+    struct record_header {
+        uint32_t    m_key_len;
+        uint32_t    m_value_len;
+    };
+
+    /// key在文件中的位置
+    struct location {
+        segment_id_type m_segment;
+        uint64_t        m_offset;   // 记录头的偏移
+        uint32_t        m_length;   // 记录的总长度
+    };
+
+    /// 分段文件，最后一个引用释放时关闭文件，使删除后正在进行的读取仍然有效
+    struct segment {
+        segment_id_type m_id;
+        int             m_fd;
+        std::string     m_path;
+        uint64_t        m_bytes;        // 文件大小
+        uint64_t        m_live_bytes;   // 有效数据大小
+        bool            m_corrupted;    // 压缩时发现无法解析的记录，不再压缩此分段
+
+        ~segment()
+        {
+            if (m_fd >= 0) {
+                ::close(m_fd);
+            }
+        }
+    };
+
+    using segment_ptr       = std::shared_ptr<segment>;
+
+    mutable std::mutex                              m_mutex;
+    std::string                                     m_directory;
+    Options                                         m_options;
+    flat_hash_index<key_type, location>             m_index;
+    std::map<segment_id_type, segment_ptr>          m_segments;     // 按创建顺序，最后一个为正在写入的分段
+    segment_id_type                                 m_next_segment;
+    uint64_t                                        m_total_bytes;
+    Stats                                           m_stats;
+
+    // 压缩线程
+    std::thread                                     m_thread;
+    std::mutex                                      m_thread_mutex;
+    std::condition_variable                         m_thread_cond;
+    bool                                            m_running;
+
+public:
+    file_victim_tier() = delete;
+    file_victim_tier(const file_victim_tier&) = delete;
+    file_victim_tier& operator=(const file_victim_tier&) = delete;
+
+    ///
+    /// construct
+    /// \param [Directory] 存放分段文件的目录，需已存在，[options] 分段与压缩参数
+    ///
+    file_victim_tier(const std::string& Directory, const Options& options) :
+        m_directory(Directory),
+        m_options(options),
+        m_next_segment(0),
+        m_total_bytes(0),
+        m_stats(),
+        m_running(false)
+    {
+        if (m_options.m_segment_bytes < kMinSegmentBytes) {
+            m_options.m_segment_bytes = kMinSegmentBytes;
+        }
+    }
+
+    ~file_victim_tier()
+    {
+        stop();
+        std::lock_guard<std::mutex> lck (m_mutex);
+        for (auto& item : m_segments) {
+            ::unlink(item.second->m_path.c_str());
+        }
+    }
+
+public:
+    ///
+    /// put
+    /// \brief 将k-v对追加写入文件，覆盖之前的值
+    /// \return bool [true]: 写入成功 [false]: 文件操作失败
+    ///
+    bool put(const key_type& key, const value_type& value);
+
+    ///
+    /// get
+    /// \brief 根据key读取value
+    /// \return bool [ture]: 有此k-v对 [false]: 无此k-v对或读取失败
+    ///
+    bool get(const key_type& key, value_type& value)
+    {
+        return _read(key, value, false);
+    }
+
+    ///
+    /// take
+    /// \brief 根据key读取value，并从本层删除，用于提升到内存层
+    /// \return bool 同get
+    ///
+    bool take(const key_type& key, value_type& value)
+    {
+        return _read(key, value, true);
+    }
+
+    ///
+    /// erase
+    /// \brief 删除key，原数据成为失效数据，由compact回收
+    ///
+    void erase(const key_type& key)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        _erase(key);
+    }
+
+    ///
+    /// exists
+    /// \return bool [ture]: 有此key [false]: 无此key
+    ///
+    bool exists(const key_type& key) const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_index.find(key) != m_index.end();
+    }
+
+    ///
+    /// compact
+    /// \brief 重写有效数据比例最低且低于Options::m_compact_ratio的一个分段，然后删除该分段
+    /// \return bool [true]: 压缩了一个分段 [false]: 没有需要压缩的分段，或压缩失败
+    /// \details 有效数据重写失败或分段中有无法解析的记录时放弃压缩，保留该分段，其中的数据仍可读取；
+    ///          无法解析的分段之后不再被选中压缩
+    ///
+    bool compact();
+
+    ///
+    /// start
+    /// \brief 启动后台线程，每隔interval压缩分段，直到没有需要压缩的分段
+    ///
+    void start(std::chrono::milliseconds interval);
+
+    ///
+    /// stop
+    /// \brief 停止后台线程
+    ///
+    void stop();
+
+    size_type size() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_index.size();
+    }
+
+    ///
+    /// get_disk_size
+    /// \return size_type 所有分段文件的总大小，包括失效数据
+    ///
+    size_type get_disk_size() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return static_cast<size_type>(m_total_bytes);
+    }
+
+    ///
+    /// get_segment_count
+    /// \return size_type 分段文件个数
+    ///
+    size_type get_segment_count() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_segments.size();
+    }
+
+    Stats get_stats() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_stats;
+    }
+
+private:
+    ///
+    /// [内部方法] 编码一条记录
+    ///
+    static void _encode(const key_type& key, const value_type& value, std::string& record)
+    {
+        record.assign(sizeof(record_header), '\0');
+        KeyCodec::encode(key, record);
+        size_type key_len = record.size() - sizeof(record_header);
+        ValueCodec::encode(value, record);
+
+        record_header header;
+        header.m_key_len = static_cast<uint32_t>(key_len);
+        header.m_value_len = static_cast<uint32_t>(record.size() - sizeof(record_header) - key_len);
+        memcpy(&record[0], &header, sizeof(header));
+    }
+
+    static bool _pread_all(int fd, char* buf, size_type len, uint64_t offset)
+    {
+        while (len > 0) {
+            ssize_t n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+            if (n <= 0) {
+                return false;
+            }
+            buf += n;
+            len -= static_cast<size_type>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    static bool _pwrite_all(int fd, const char* buf, size_type len, uint64_t offset)
+    {
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd, buf, len, static_cast<off_t>(offset));
+            if (n <= 0) {
+                return false;
+            }
+            buf += n;
+            len -= static_cast<size_type>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    bool _read(const key_type& key, value_type& value, bool Take);
+
+    ///
+    /// [内部方法] 在锁内追加一条已编码的记录并更新索引
+    /// \param [Limit] 追加后是否按总大小上限删除最旧的分段，compact重写记录时为false，
+    ///        否则被压缩的分段本身可能被删除，其中尚未重写的有效数据随之丢失
+    ///
+    bool _append(const key_type& key, const std::string& record, bool Limit = true);
+
+    ///
+    /// [内部方法] 在锁内按总大小上限删除最旧的分段，至少保留正在写入的分段
+    ///
+    void _limit_bytes()
+    {
+        while (m_options.m_max_bytes != 0 && m_total_bytes > m_options.m_max_bytes && m_segments.size() > 1) {
+            _drop_segment(m_segments.begin()->first);
+            ++m_stats.m_drop_cnt;
+        }
+    }
+
+    ///
+    /// [内部方法] 在锁内删除key，将原数据记为失效
+    ///
+    void _erase(const key_type& key)
+    {
+        auto ite = m_index.find(key);
+        if (ite == m_index.end()) {
+            return;
+        }
+        _release(ite->second);
+        m_index.erase(ite);
+    }
+
+    void _release(const location& loc)
+    {
+        auto seg = m_segments.find(loc.m_segment);
+        if (seg != m_segments.end()) {
+            seg->second->m_live_bytes -= loc.m_length;
+        }
+    }
+
+    ///
+    /// [内部方法] 在锁内创建新的分段作为写入分段
+    ///
+    bool _roll_segment();
+
+    ///
+    /// [内部方法] 在锁内删除一个分段，其中仍有效的key一并删除
+    ///
+    void _drop_segment(segment_id_type id);
+
+    void _run(std::chrono::milliseconds interval);
+};
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool file_victim_tier<Key, Value, ValueCodec, KeyCodec>::put(const key_type& key, const value_type& value)
+{
+    // 编码在锁外进行
+    std::string record;
+    _encode(key, value, record);
+
+    std::lock_guard<std::mutex> lck (m_mutex);
+    return _append(key, record);
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool file_victim_tier<Key, Value, ValueCodec, KeyCodec>::_read(const key_type& key, value_type& value, bool Take)
+{
+    location loc;
+    segment_ptr seg;
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        ++m_stats.m_get_cnt;
+        auto ite = m_index.find(key);
+        if (ite == m_index.end()) {
+            return false;
+        }
+        loc = ite->second;
+        seg = m_segments[loc.m_segment];
+    }
+
+    // 在锁外读取，seg持有文件描述符，分段被删除后仍可读取
+    std::string record(loc.m_length, '\0');
+    if (!_pread_all(seg->m_fd, &record[0], loc.m_length, loc.m_offset)) {
+        return false;
+    }
+
+    record_header header;
+    memcpy(&header, record.data(), sizeof(header));
+    if (!ValueCodec::decode(record.data() + sizeof(header) + header.m_key_len, header.m_value_len, value)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lck (m_mutex);
+    ++m_stats.m_hit_cnt;
+    if (Take) {
+        // 读取期间key可能已被更新，只删除读到的这条记录
+        auto ite = m_index.find(key);
+        if (ite != m_index.end() && ite->second.m_segment == loc.m_segment &&
+            ite->second.m_offset == loc.m_offset) {
+            _release(ite->second);
+            m_index.erase(ite);
+        }
+    }
+    return true;
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool file_victim_tier<Key, Value, ValueCodec, KeyCodec>::_append(const key_type& key, const std::string& record,
+                                                                  bool Limit)
+{
+    // 当前分段为空时直接写入，超过分段大小的记录不会单独占用一个分段
+    if (m_segments.empty() ||
+        (m_segments.rbegin()->second->m_bytes != 0 &&
+         m_segments.rbegin()->second->m_bytes + record.size() > m_options.m_segment_bytes)) {
+        if (!_roll_segment()) {
+            return false;
+        }
+    }
+
+    segment& seg = *m_segments.rbegin()->second;
+    if (!_pwrite_all(seg.m_fd, record.data(), record.size(), seg.m_bytes)) {
+        return false;
+    }
+
+    _erase(key);
+    m_index.insert(key, location{seg.m_id, seg.m_bytes, static_cast<uint32_t>(record.size())});
+    seg.m_bytes += record.size();
+    seg.m_live_bytes += record.size();
+    m_total_bytes += record.size();
+
+    if (Limit) {
+        _limit_bytes();
+    }
+    return true;
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool file_victim_tier<Key, Value, ValueCodec, KeyCodec>::_roll_segment()
+{
+    segment_ptr seg = std::make_shared<segment>();
+    seg->m_id = m_next_segment;
+    seg->m_path = m_directory + "/victim_" + std::to_string(seg->m_id) + ".seg";
+    seg->m_bytes = 0;
+    seg->m_live_bytes = 0;
+    seg->m_corrupted = false;
+    seg->m_fd = ::open(seg->m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (seg->m_fd < 0) {
+        return false;
+    }
+
+    ++m_next_segment;
+    m_segments[seg->m_id] = seg;
+    return true;
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void file_victim_tier<Key, Value, ValueCodec, KeyCodec>::_drop_segment(segment_id_type id)
+{
+    auto seg = m_segments.find(id);
+    if (seg == m_segments.end()) {
+        return;
+    }
+
+    if (seg->second->m_live_bytes != 0) {
+        std::vector<key_type> keys;
+        for (auto& item : m_index) {
+            if (item.second.m_segment == id) {
+                keys.push_back(item.first);
+            }
+        }
+        for (auto& key : keys) {
+            m_index.erase(key);
+        }
+    }
+
+    m_total_bytes -= seg->second->m_bytes;
+    ::unlink(seg->second->m_path.c_str());
+    m_segments.erase(seg);
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool file_victim_tier<Key, Value, ValueCodec, KeyCodec>::compact()
+{
+    // 选择有效数据比例最低的已写满分段
+    segment_ptr victim;
+    uint64_t length = 0;
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        double min_ratio = m_options.m_compact_ratio;
+        for (auto ite = m_segments.begin(); ite != m_segments.end() && std::next(ite) != m_segments.end(); ++ite) {
+            const segment& seg = *ite->second;
+            if (seg.m_corrupted) {
+                continue;
+            }
+            double ratio = seg.m_bytes == 0 ? 0.0 : 1.0 * seg.m_live_bytes / seg.m_bytes;
+            if (ratio < min_ratio) {
+                min_ratio = ratio;
+                victim = ite->second;
+            }
+        }
+        if (!victim) {
+            return false;
+        }
+        length = victim->m_bytes;
+    }
+
+    // 已写满的分段不再变化，在锁外读取整个文件
+    std::string data(static_cast<size_type>(length), '\0');
+    if (length != 0 && !_pread_all(victim->m_fd, &data[0], data.size(), 0)) {
+        return false;
+    }
+
+    // 逐条检查记录是否仍有效，有效的记录追加到正在写入的分段；
+    // 已重写的记录索引已指向新位置，中途放弃时保留分段即可，不会丢失数据
+    uint64_t offset = 0;
+    while (offset < length) {
+        record_header header;
+        key_type key;
+        uint64_t record_len = 0;
+        bool parsed = offset + sizeof(record_header) <= length;
+        if (parsed) {
+            memcpy(&header, data.data() + offset, sizeof(header));
+            record_len = sizeof(header) + static_cast<uint64_t>(header.m_key_len) + header.m_value_len;
+            parsed = offset + record_len <= length &&
+                KeyCodec::decode(data.data() + offset + sizeof(header), header.m_key_len, key);
+        }
+
+        std::lock_guard<std::mutex> lck (m_mutex);
+        if (!parsed) {
+            victim->m_corrupted = true;
+            return false;
+        }
+        auto ite = m_index.find(key);
+        if (ite != m_index.end() && ite->second.m_segment == victim->m_id && ite->second.m_offset == offset) {
+            if (!_append(key, data.substr(static_cast<size_type>(offset), static_cast<size_type>(record_len)), false)) {
+                return false;
+            }
+        }
+        offset += record_len;
+    }
+
+    // 重写期间总大小可能暂时超出上限，删除被压缩的分段后再检查
+    std::lock_guard<std::mutex> lck (m_mutex);
+    _drop_segment(victim->m_id);
+    ++m_stats.m_compact_cnt;
+    _limit_bytes();
+    return true;
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void file_victim_tier<Key, Value, ValueCodec, KeyCodec>::start(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lck (m_thread_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&file_victim_tier::_run, this, interval);
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void file_victim_tier<Key, Value, ValueCodec, KeyCodec>::stop()
+{
+    {
+        std::lock_guard<std::mutex> lck (m_thread_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_thread_cond.notify_all();
+    m_thread.join();
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void file_victim_tier<Key, Value, ValueCodec, KeyCodec>::_run(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lck (m_thread_mutex);
+    while (m_running) {
+        m_thread_cond.wait_for(lck, interval);
+        if (!m_running) {
+            break;
+        }
+
+        lck.unlock();
+        // 逐个压缩，分段之间让出CPU
+        while (compact()) {
+            std::this_thread::yield();
+        }
+        lck.lock();
+    }
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
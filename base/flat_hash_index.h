@@ -0,0 +1,520 @@
+#ifndef COMMON_BASE_FLAT_HASH_INDEX_H
+#define COMMON_BASE_FLAT_HASH_INDEX_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 定义TINYCOMMON_NO_SIMD可强制使用逐字节比较
+#if defined(__SSE2__) && !defined(TINYCOMMON_NO_SIMD)
+#define TINYCOMMON_FLAT_HASH_INDEX_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 开放寻址的hash索引（Swiss table风格）
+/// \details 每个槽位有1字节的控制字节：空槽为0x80，非空槽为hash的低7位（tag）；
+///          查找时一次比较16个控制字节（SSE2，不支持时退化为逐字节比较），只有tag相同的槽位才比较key，
+///          未命中时通常只需访问控制字节；完整hash单独连续存放，用于扩容与删除时计算home，无需重新计算；
+///          采用线性探测，删除时将后续元素前移（backward shift），不产生墓碑，删除频繁时探测长度不会退化
+/// \warning 插入与删除会使迭代器与引用失效；非线程安全
+///
+template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_index
+{
+public:
+    using key_type          = Key;
+    using mapped_type       = Mapped;
+    using value_type        = std::pair<Key, Mapped>;
+    using size_type         = size_t;
+    using hash_type         = uint64_t;
+
+private:
+    using ctrl_type         = int8_t;
+    using storage_type      = typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type;
+
+    static const ctrl_type  kEmpty = static_cast<ctrl_type>(-128);     // 0x80
+    static const size_type  kGroupWidth = 16;                          // 一次探测的槽位数
+    static const size_type  kMinCapacity = 16;
+
+    std::unique_ptr<ctrl_type[]>    m_ctrl;     // capacity + kGroupWidth 个，末尾为开头kGroupWidth-1个的镜像
+    std::unique_ptr<hash_type[]>    m_hashes;   // 缓存的完整hash，删除前移时顺序扫描，单独存放以减少cache miss
+    std::unique_ptr<storage_type[]> m_slots;
+    size_type                       m_capacity; // 2的幂
+    size_type                       m_size;
+    Hash                            m_hash;
+    KeyEqual                        m_equal;
+
+public:
+    class iterator
+    {
+        friend class flat_hash_index;
+
+        flat_hash_index*    m_index;
+        size_type           m_pos;
+
+        iterator(flat_hash_index* index, size_type pos) : m_index(index), m_pos(pos) {}
+
+    public:
+        iterator() : m_index(nullptr), m_pos(0) {}
+
+        value_type& operator*() const { return m_index->_value(m_pos); }
+        value_type* operator->() const { return &m_index->_value(m_pos); }
+
+        iterator& operator++()
+        {
+            m_pos = m_index->_next_full(m_pos + 1);
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const iterator& other) const { return m_pos != other.m_pos; }
+    };
+
+    class const_iterator
+    {
+        friend class flat_hash_index;
+
+        const flat_hash_index*  m_index;
+        size_type               m_pos;
+
+        const_iterator(const flat_hash_index* index, size_type pos) : m_index(index), m_pos(pos) {}
+
+    public:
+        const_iterator() : m_index(nullptr), m_pos(0) {}
+        const_iterator(const iterator& ite) : m_index(ite.m_index), m_pos(ite.m_pos) {}
+
+        const value_type& operator*() const { return m_index->_value(m_pos); }
+        const value_type* operator->() const { return &m_index->_value(m_pos); }
+
+        const_iterator& operator++()
+        {
+            m_pos = m_index->_next_full(m_pos + 1);
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const const_iterator& other) const { return m_pos != other.m_pos; }
+    };
+
+public:
+    flat_hash_index() :
+        m_capacity(0),
+        m_size(0)
+    {
+        _allocate(kMinCapacity);
+    }
+
+    flat_hash_index(const flat_hash_index& from) :
+        m_capacity(0),
+        m_size(0),
+        m_hash(from.m_hash),
+        m_equal(from.m_equal)
+    {
+        _allocate(from.m_capacity);
+        std::memcpy(m_ctrl.get(), from.m_ctrl.get(), m_capacity + kGroupWidth);
+        for (size_type i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] != kEmpty) {
+                m_hashes[i] = from.m_hashes[i];
+                new (&m_slots[i]) value_type(from._value(i));
+            }
+        }
+        m_size = from.m_size;
+    }
+
+    flat_hash_index& operator=(const flat_hash_index& from)
+    {
+        if (this != &from) {
+            flat_hash_index tmp(from);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~flat_hash_index()
+    {
+        _destroy_all();
+    }
+
+public:
+    iterator begin()
+    {
+        return iterator(this, _next_full(0));
+    }
+
+    iterator end()
+    {
+        return iterator(this, m_capacity);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, _next_full(0));
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, m_capacity);
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+
+    ///
+    /// find
+    /// \brief 查找key
+    /// \return iterator 未找到时返回end()
+    ///
+    iterator find(const key_type& key)
+    {
+        return iterator(this, _find(key, _hash(key)));
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        return const_iterator(this, _find(key, _hash(key)));
+    }
+
+    ///
+    /// insert
+    /// \brief 插入k-v对，key已存在时不修改
+    /// \return pair<iterator, bool> [second = true]: 插入成功 [false]: key已存在
+    ///
+    std::pair<iterator, bool> insert(const key_type& key, const mapped_type& mapped)
+    {
+        hash_type h = _hash(key);
+        size_type pos = _find(key, h);
+        if (pos != m_capacity) {
+            return std::make_pair(iterator(this, pos), false);
+        }
+        pos = _insert_new(h, key, mapped);
+        return std::make_pair(iterator(this, pos), true);
+    }
+
+    ///
+    /// operator[]
+    /// \brief 返回key对应的mapped的引用，key不存在时插入默认值
+    ///
+    mapped_type& operator[](const key_type& key)
+    {
+        hash_type h = _hash(key);
+        size_type pos = _find(key, h);
+        if (pos == m_capacity) {
+            pos = _insert_new(h, key, mapped_type());
+        }
+        return _value(pos).second;
+    }
+
+    ///
+    /// erase
+    /// \brief 删除key
+    /// \return size_type 删除的元素个数（0或1）
+    ///
+    size_type erase(const key_type& key)
+    {
+        size_type pos = _find(key, _hash(key));
+        if (pos == m_capacity) {
+            return 0;
+        }
+        _erase_at(pos);
+        return 1;
+    }
+
+    ///
+    /// erase
+    /// \brief 删除迭代器指向的元素
+    /// \warning 删除后所有迭代器失效（后续元素可能前移至此位置）
+    ///
+    void erase(iterator ite)
+    {
+        assert(ite.m_pos < m_capacity && m_ctrl[ite.m_pos] != kEmpty);
+        _erase_at(ite.m_pos);
+    }
+
+    void clear()
+    {
+        _destroy_all();
+        std::memset(m_ctrl.get(), static_cast<unsigned char>(kEmpty), m_capacity + kGroupWidth);
+        m_size = 0;
+    }
+
+    ///
+    /// reserve
+    /// \brief 预留至少可容纳n个元素的空间
+    ///
+    void reserve(size_type n)
+    {
+        size_type cap = m_capacity;
+        while (n > _max_load(cap)) {
+            cap *= 2;
+        }
+        if (cap != m_capacity) {
+            _rehash(cap);
+        }
+    }
+
+    void swap(flat_hash_index& other)
+    {
+        std::swap(m_ctrl, other.m_ctrl);
+        std::swap(m_hashes, other.m_hashes);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_hash, other.m_hash);
+        std::swap(m_equal, other.m_equal);
+    }
+
+private:
+    ///
+    /// [内部方法] 一组控制字节的匹配结果，第i位对应pos+i
+    ///
+    struct GroupMask {
+        uint32_t    m_match;    // tag相同的槽位
+        uint32_t    m_empty;    // 空槽位
+    };
+
+    GroupMask _probe_group(size_type pos, ctrl_type tag) const
+    {
+        GroupMask mask;
+        const ctrl_type* ctrl = m_ctrl.get() + pos;
+#if defined(TINYCOMMON_FLAT_HASH_INDEX_SSE2)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        mask.m_match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), group)));
+        // 只有空槽位的最高位为1
+        mask.m_empty = static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+        mask.m_match = 0;
+        mask.m_empty = 0;
+        for (size_type i = 0; i < kGroupWidth; ++i) {
+            mask.m_match |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+            mask.m_empty |= static_cast<uint32_t>(ctrl[i] == kEmpty) << i;
+        }
+#endif
+        return mask;
+    }
+
+    static size_type _lowest_bit(uint32_t mask)
+    {
+        return static_cast<size_type>(__builtin_ctz(mask));
+    }
+
+    hash_type _hash(const key_type& key) const
+    {
+        // std::hash对整数通常为恒等映射，需要打散（murmur3 fmix64）
+        hash_type h = static_cast<hash_type>(m_hash(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static ctrl_type _tag(hash_type h)
+    {
+        return static_cast<ctrl_type>(h & 0x7f);
+    }
+
+    size_type _home(hash_type h) const
+    {
+        return static_cast<size_type>(h >> 7) & (m_capacity - 1);
+    }
+
+    static size_type _max_load(size_type cap)
+    {
+        // 最大负载因子3/4
+        return cap - cap / 4;
+    }
+
+    value_type& _value(size_type pos)
+    {
+        return *reinterpret_cast<value_type*>(&m_slots[pos]);
+    }
+
+    const value_type& _value(size_type pos) const
+    {
+        return *reinterpret_cast<const value_type*>(&m_slots[pos]);
+    }
+
+    void _set_ctrl(size_type pos, ctrl_type ctrl)
+    {
+        m_ctrl[pos] = ctrl;
+        // 维护末尾的镜像，使跨越末尾的一组可以一次读取
+        if (pos < kGroupWidth - 1) {
+            m_ctrl[m_capacity + pos] = ctrl;
+        }
+    }
+
+    size_type _next_full(size_type pos) const
+    {
+        while (pos < m_capacity && m_ctrl[pos] == kEmpty) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    ///
+    /// [内部方法] 查找key所在位置，未找到时返回m_capacity
+    /// \details 线性探测的不变式保证元素与其home之间没有空槽位，因此遇到含空槽位的组即可停止
+    ///
+    size_type _find(const key_type& key, hash_type h) const
+    {
+        const size_type mask = m_capacity - 1;
+        const ctrl_type tag = _tag(h);
+        size_type pos = _home(h);
+        while (true) {
+            GroupMask group = _probe_group(pos, tag);
+            while (group.m_match != 0) {
+                size_type idx = (pos + _lowest_bit(group.m_match)) & mask;
+                // tag已过滤掉绝大部分不相等的key，直接比较key，避免再访问m_hashes
+                if (m_equal(_value(idx).first, key)) {
+                    return idx;
+                }
+                group.m_match &= group.m_match - 1;
+            }
+            if (group.m_empty != 0) {
+                return m_capacity;
+            }
+            pos = (pos + kGroupWidth) & mask;
+        }
+    }
+
+    ///
+    /// [内部方法] 查找h对应的第一个空槽位
+    ///
+    size_type _find_empty(hash_type h) const
+    {
+        const size_type mask = m_capacity - 1;
+        size_type pos = _home(h);
+        while (true) {
+            GroupMask group = _probe_group(pos, kEmpty);
+            if (group.m_empty != 0) {
+                return (pos + _lowest_bit(group.m_empty)) & mask;
+            }
+            pos = (pos + kGroupWidth) & mask;
+        }
+    }
+
+    size_type _insert_new(hash_type h, const key_type& key, const mapped_type& mapped)
+    {
+        if (m_size + 1 > _max_load(m_capacity)) {
+            _rehash(m_capacity * 2);
+        }
+        size_type pos = _find_empty(h);
+        new (&m_slots[pos]) value_type(key, mapped);
+        m_hashes[pos] = h;
+        _set_ctrl(pos, _tag(h));
+        ++m_size;
+        return pos;
+    }
+
+    ///
+    /// [内部方法] 删除pos处的元素，并将后续元素前移（Knuth Algorithm R）
+    ///
+    void _erase_at(size_type pos)
+    {
+        const size_type mask = m_capacity - 1;
+        _value(pos).~value_type();
+        --m_size;
+
+        // 先用控制字节找到所在簇的末尾，扫描长度确定后m_hashes的访问可以并行发出
+        size_type cluster = 0;
+        while (true) {
+            GroupMask group = _probe_group((pos + 1 + cluster) & mask, kEmpty);
+            if (group.m_empty != 0) {
+                cluster += _lowest_bit(group.m_empty);
+                break;
+            }
+            cluster += kGroupWidth;
+        }
+
+        size_type hole = pos;
+        for (size_type i = 1; i <= cluster; ++i) {
+            size_type next = (pos + i) & mask;
+            // home位于(hole, next]之间的元素不能移动到hole，否则会越过其home
+            size_type home = _home(m_hashes[next]);
+            bool stay = hole <= next ? (hole < home && home <= next)
+                                     : (hole < home || home <= next);
+            if (stay) {
+                continue;
+            }
+            new (&m_slots[hole]) value_type(std::move(_value(next)));
+            _value(next).~value_type();
+            m_hashes[hole] = m_hashes[next];
+            _set_ctrl(hole, m_ctrl[next]);
+            hole = next;
+        }
+        _set_ctrl(hole, kEmpty);
+    }
+
+    void _allocate(size_type cap)
+    {
+        m_capacity = cap;
+        m_ctrl.reset(new ctrl_type[cap + kGroupWidth]);
+        std::memset(m_ctrl.get(), static_cast<unsigned char>(kEmpty), cap + kGroupWidth);
+        m_hashes.reset(new hash_type[cap]);
+        m_slots.reset(new storage_type[cap]);
+    }
+
+    ///
+    /// [内部方法] 扩容，使用缓存的hash，不重新计算
+    ///
+    void _rehash(size_type cap)
+    {
+        std::unique_ptr<ctrl_type[]> old_ctrl(std::move(m_ctrl));
+        std::unique_ptr<hash_type[]> old_hashes(std::move(m_hashes));
+        std::unique_ptr<storage_type[]> old_slots(std::move(m_slots));
+        size_type old_capacity = m_capacity;
+
+        _allocate(cap);
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] == kEmpty) {
+                continue;
+            }
+            hash_type h = old_hashes[i];
+            value_type& value = *reinterpret_cast<value_type*>(&old_slots[i]);
+            size_type pos = _find_empty(h);
+            new (&m_slots[pos]) value_type(std::move(value));
+            value.~value_type();
+            m_hashes[pos] = h;
+            _set_ctrl(pos, _tag(h));
+        }
+    }
+
+    void _destroy_all()
+    {
+        if (!m_ctrl) {
+            return;
+        }
+        for (size_type i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] != kEmpty) {
+                _value(i).~value_type();
+            }
+        }
+    }
+};
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef COMMON_BASE_LOCKFREE_CIRCULAR_QUEUE_H
+#define COMMON_BASE_LOCKFREE_CIRCULAR_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 多生产者、多消费者的无锁有界环状队列
+/// \details 每个位置带有序号，生产者与消费者各自通过CAS占用位置，之后只访问自己占用的位置；
+///          与circular_queue不同，队列满时push失败而不是覆盖最旧的对象，取出的对象以移动方式返回
+/// \param [T] 对象类型，[BufSize] 队列容量，需为2的幂
+///
+template<typename T, size_t BufSize = 1024>
+class lockfree_circular_queue {
+public:
+    using value_type        = T;
+    using size_type         = size_t;
+    using sequence_type     = size_t;
+
+    static_assert(BufSize >= 2 && (BufSize & (BufSize - 1)) == 0,
+                  "lockfree_circular_queue requires BufSize to be a power of 2");
+
+private:
+    static const size_type  kCacheLine = 64;
+    static const size_type  kMask = BufSize - 1;
+
+    struct cell {
+        std::atomic<sequence_type>  m_seq;      // 等于位置序号时可写，等于位置序号 + 1时可读
+        value_type                  m_value;
+    };
+
+    std::unique_ptr<cell[]>     m_buffer;
+
+    char                        m_pad0[kCacheLine];
+    std::atomic<sequence_type>  m_enqueue;      // 下一个要写入的序号
+    char                        m_pad1[kCacheLine - sizeof(std::atomic<sequence_type>)];
+    std::atomic<sequence_type>  m_dequeue;      // 下一个要读取的序号
+    char                        m_pad2[kCacheLine - sizeof(std::atomic<sequence_type>)];
+
+public:
+    lockfree_circular_queue() :
+        m_buffer(new cell[BufSize]) {
+        for (size_type i = 0; i < BufSize; ++i) {
+            m_buffer[i].m_seq.store(i, std::memory_order_relaxed);
+        }
+        m_enqueue.store(0, std::memory_order_relaxed);
+        m_dequeue.store(0, std::memory_order_relaxed);
+    }
+
+    lockfree_circular_queue(const lockfree_circular_queue&) = delete;
+    lockfree_circular_queue& operator=(const lockfree_circular_queue&) = delete;
+
+public:
+    ///
+    /// capacity
+    /// \return size_type 队列容量
+    ///
+    size_type capacity() const {
+        return BufSize;
+    }
+
+    ///
+    /// size
+    /// \brief 当前队列中的对象数量
+    /// \return size_type 并发读写时为近似值
+    ///
+    size_type size() const {
+        sequence_type dequeue = m_dequeue.load(std::memory_order_relaxed);
+        sequence_type enqueue = m_enqueue.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? static_cast<size_type>(enqueue - dequeue) : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    ///
+    /// try_push
+    /// \brief 向队列尾部追加对象，不等待
+    /// \return bool [true]: 追加成功 [false]: 队列已满
+    ///
+    bool try_push(const value_type& from) {
+        return _push(from);
+    }
+
+    bool try_push(value_type&& from) {
+        return _push(std::move(from));
+    }
+
+    ///
+    /// try_pop
+    /// \brief 弹出队列头部对象，不等待
+    /// \param [out]: to
+    /// \return bool [true]: 弹出成功 [false]: 队列为空
+    ///
+    bool try_pop(value_type& to);
+
+private:
+    template<typename U>
+    bool _push(U&& from);
+};
+
+template<typename T, size_t BufSize>
+template<typename U>
+bool lockfree_circular_queue<T, BufSize>::_push(U&& from) {
+    sequence_type pos = m_enqueue.load(std::memory_order_relaxed);
+    cell* c;
+    while (true) {
+        c = &m_buffer[pos & kMask];
+        sequence_type seq = c->m_seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 该位置的对象尚未被读取，队列已满
+            return false;
+        } else {
+            pos = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+
+    c->m_value = std::forward<U>(from);
+    c->m_seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t BufSize>
+bool lockfree_circular_queue<T, BufSize>::try_pop(value_type& to) {
+    sequence_type pos = m_dequeue.load(std::memory_order_relaxed);
+    cell* c;
+    while (true) {
+        c = &m_buffer[pos & kMask];
+        sequence_type seq = c->m_seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 该位置尚未写入，队列为空
+            return false;
+        } else {
+            pos = m_dequeue.load(std::memory_order_relaxed);
+        }
+    }
+
+    to = std::move(c->m_value);
+    // 位置在下一圈可写
+    c->m_seq.store(pos + BufSize, std::memory_order_release);
+    return true;
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
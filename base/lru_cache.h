@@ -1,10 +1,22 @@
 #ifndef COMMON_BASE_LRU_CACHE_H
 #define COMMON_BASE_LRU_CACHE_H
 
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
+
+#include "bloom_filter.h"
+#include "flat_hash_index.h"
+#include "space_saving.h"
+#include "windowed_rate.h"
 
 namespace tinycommon{
 namespace base {
@@ -25,18 +37,126 @@ public:
     struct Stats {
         size_type   m_get_cnt; //总的请求次数
         size_type   m_hit_cnt; //命中次数
+        size_type   m_ghost_hit_cnt; //未命中但命中ghost表的次数（若容量更大本可命中）
+        size_type   m_filter_reject_cnt; //被filter直接判定为未命中的get次数，不计入m_get_cnt
+    };
+
+    /// 按最近使用顺序遍历时返回的元素
+    struct recency_entry {
+        key_type        m_key;
+        value_ptr_type  m_value;
+        size_type       m_rank;     // 遍历到此元素时已遍历的元素个数，0为最近使用，可近似表示元素的"年龄"
+    };
+
+    using hot_key           = typename space_saving<key_type>::Counter;
+
+    /// 元素被淘汰时的回调，在锁内调用
+    using discard_callback  = std::function<void(const key_type&, const value_ptr_type&)>;
+
+private:
+    using ghost_iterator    = typename std::list<key_type>::iterator;
+    using filter_type       = counting_bloom_filter<key_type>;
+    using hot_key_tracker   = space_saving<key_type>;
+
+    /// 遍历游标的状态，由容器保存，元素被移动或淘汰时容器负责将游标后移
+    struct cursor_state {
+        iterator    m_pos;      // 下一个要遍历的元素
+        size_type   m_rank;     // 已遍历的元素个数
+    };
+    using cursor_iterator   = typename std::list<cursor_state>::iterator;
+
+public:
+    ///
+    /// 按最近使用顺序分批遍历的游标，由open_cursor创建，析构时自动关闭
+    /// \warning 游标不能在容器析构后使用或析构
+    ///
+    class recency_cursor
+    {
+        friend class LRU_cache;
+
+        LRU_cache*          m_cache;
+        cursor_iterator     m_state;
+
+        recency_cursor(LRU_cache* cache, cursor_iterator state) : m_cache(cache), m_state(state) {}
+
+    public:
+        recency_cursor() : m_cache(nullptr) {}
+        recency_cursor(const recency_cursor&) = delete;
+        recency_cursor& operator=(const recency_cursor&) = delete;
+
+        recency_cursor(recency_cursor&& from) : m_cache(from.m_cache), m_state(from.m_state)
+        {
+            from.m_cache = nullptr;
+        }
+
+        recency_cursor& operator=(recency_cursor&& from)
+        {
+            if (this != &from) {
+                close();
+                m_cache = from.m_cache;
+                m_state = from.m_state;
+                from.m_cache = nullptr;
+            }
+            return *this;
+        }
+
+        ~recency_cursor()
+        {
+            close();
+        }
+
+        bool is_open() const
+        {
+            return m_cache != nullptr;
+        }
+
+        void close()
+        {
+            if (m_cache != nullptr) {
+                m_cache->_close_cursor(m_state);
+                m_cache = nullptr;
+            }
+        }
     };
 
 private:
     mutable std::mutex              m_mutex;
     std::list<list_value>           m_list;
-    std::unordered_map<key_type, iterator>  m_hash_table;
+    flat_hash_index<key_type, iterator>     m_hash_table;   // 开放寻址，查找时一次探测16个槽位
 
     size_type                       m_max_size;         // 可保有的最大元素数量
     size_type                       m_max_memory_size;  // 最大内存大小
 
+    // ghost表：只记录最近被淘汰元素的key，用于估计扩容带来的边际命中收益
+    std::list<key_type>             m_ghost_list;
+    std::unordered_map<key_type, ghost_iterator>    m_ghost_table;
+    size_type                       m_max_ghost_size;   // ghost表最大长度，为0时不记录
+
+    // 可选的成员过滤器，修改在锁内进行，查询无锁，用于在不加锁的情况下拒绝未命中的请求
+    // 无锁查询可能仍持有旧的过滤器，被替换的过滤器保存在m_filter_storage中，直到容器析构才释放
+    std::atomic<filter_type*>       m_filter;
+    std::vector<std::unique_ptr<filter_type>>   m_filter_storage;
+    std::atomic<size_type>          m_filter_reject_cnt;
+
+    // 分批遍历的游标，通常为空，get/push/淘汰时只需检查是否为空
+    std::list<cursor_state>         m_cursors;
+
+    // 可选的热点key统计，在get中按采样周期更新
+    std::unique_ptr<hot_key_tracker>    m_hot_keys;
+    size_type                       m_hot_key_period;   // 采样周期，每m_hot_key_period次get记录一次
+    size_type                       m_hot_key_tick;
+
+    discard_callback                m_discard_callback;
+
     Stats                           m_stats;
 
+    // 在锁内发布、无锁读取的统计值，供监控高频轮询，不增加锁竞争
+    std::atomic<size_type>          m_published_get_cnt;
+    std::atomic<size_type>          m_published_hit_cnt;
+    std::atomic<size_type>          m_published_size;
+    std::atomic<uint32_t>           m_published_generation; // 整体替换统计值（重置、拷贝）期间为奇数
+    mutable windowed_rate<>         m_hit_rate_window;
+
 public:
     LRU_cache() = delete;
 
@@ -63,6 +183,29 @@ public:
     ///
     void push(const key_type& key, const value_ptr_type& value);
 
+    ///
+    /// push_if_absent
+    /// \brief 容器中无此key且pred()返回true时压入k-v对，判断与压入在同一次加锁内完成
+    /// \param [in]: key, value, pred 无参数、返回bool的可调用对象
+    /// \return bool [true]: 已压入 [false]: 容器中已有此key或pred()返回false
+    /// \warning pred在容器的锁内调用，应尽快返回，且不能再调用此容器的任何方法
+    ///
+    template <typename Pred>
+    bool push_if_absent(const key_type& key, const value_ptr_type& value, Pred pred)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        if (m_hash_table.find(key) != m_hash_table.end() || !pred()) {
+            return false;
+        }
+        _push(key, value);
+        return true;
+    }
+
+    bool push_if_absent(const key_type& key, const value_ptr_type& value)
+    {
+        return push_if_absent(key, value, []() { return true; });
+    }
+
     ///
     /// get
     /// \brief 根据key，从容器中取出value
@@ -72,6 +215,15 @@ public:
     ///
     bool get(const key_type& key, value_ptr_type& value);
 
+    ///
+    /// try_get
+    /// \brief 与get相同，但容器正被其他线程占用时立即返回，不等待
+    /// \param [in]: key, [out]: value, [out]: busy 为true时表示因容器被占用而未查找
+    /// \return bool [ture]: 容器中有此k-v对 [false]: 容器中无此k-v对或容器被占用
+    /// \details 用于不能阻塞的线程（如事件循环），busy时可稍后重试或改用async_lru_cache提交
+    ///
+    bool try_get(const key_type& key, value_ptr_type& value, bool& busy);
+
     ///
     /// exists
     /// \brief 判断容器中是否有key对应的k-v对
@@ -81,6 +233,11 @@ public:
     ///
     bool exists(const key_type& key) const
     {
+        filter_type* filter = m_filter.load(std::memory_order_acquire);
+        if (filter && !filter->may_contain(key)) {
+            return false;
+        }
+
         std::lock_guard<std::mutex> lck(m_mutex);
         auto ite = m_hash_table.find(key);
         return ite == m_hash_table.end() ? false : true;
@@ -95,7 +252,44 @@ public:
     {
         std::lock_guard<std::mutex> lck(m_mutex);
         return static_cast<rate_type>(m_stats.m_hit_cnt) /
-            static_cast<rate_type>(m_stats.m_get_cnt);
+            static_cast<rate_type>(m_stats.m_get_cnt +
+                                   m_filter_reject_cnt.load(std::memory_order_relaxed));
+    }
+
+    ///
+    /// hit_rate_relaxed
+    /// \brief 与get_hit_rate相同，但不加锁，读取的是最近发布的计数
+    /// \return rate_type(double) 没有get时返回0，不会大于1
+    /// \details 命中次数与请求次数总是来自同一次reset_stats之后，与reset_stats并发时重新读取
+    ///
+    rate_type hit_rate_relaxed() const
+    {
+        size_type hit, get;
+        _load_published_stats(hit, get);
+        return get == 0 ? 0.0 : static_cast<rate_type>(hit) / static_cast<rate_type>(get);
+    }
+
+    ///
+    /// hit_rate_window
+    /// \brief 不加锁地获取最近一段时间（见set_hit_rate_window，默认60秒）的命中率
+    /// \return rate_type(double) 窗口内没有get时返回0
+    /// \details 由调用方记录计数快照，get不感知时间窗口；需定期调用（如监控轮询）才能得到准确的窗口，见windowed_rate
+    ///
+    rate_type hit_rate_window() const
+    {
+        // reset_stats与拷贝会改变发布计数的代，之前记录的快照随之失效
+        size_type hit, get;
+        uint32_t generation = _load_published_stats(hit, get);
+        return m_hit_rate_window.update(hit, get, generation);
+    }
+
+    ///
+    /// set_hit_rate_window
+    /// \brief 设置hit_rate_window的窗口长度，已有的快照失效
+    ///
+    void set_hit_rate_window(std::chrono::milliseconds Window)
+    {
+        m_hit_rate_window.set_window(Window);
     }
 
     ///
@@ -107,20 +301,222 @@ public:
         std::lock_guard<std::mutex> lck (m_mutex);
         m_stats.m_hit_cnt = 0;
         m_stats.m_get_cnt = 0;
+        m_stats.m_ghost_hit_cnt = 0;
+        _republish_stats(0);
+    }
+
+    ///
+    /// get_stats
+    /// \brief 获取统计信息的拷贝
+    /// \return Stats
+    ///
+    Stats get_stats() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        Stats stats = m_stats;
+        stats.m_filter_reject_cnt = m_filter_reject_cnt.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    ///
+    /// size
+    /// \brief 获取当前保有的元素个数
+    /// \return size_type
+    ///
+    size_type size() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return _get_cache_size();
+    }
+
+    ///
+    /// size_relaxed
+    /// \brief 与size相同，但不加锁，读取的是最近发布的元素个数
+    ///
+    size_type size_relaxed() const
+    {
+        return m_published_size.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// get_memory_size
+    /// \brief 获取当前占用内存大小（以字节为单位）
+    /// \return size_type
+    ///
+    size_type get_memory_size() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return _get_memory_size();
+    }
+
+    ///
+    /// get_max_memory_size
+    /// \brief 获取最大内存大小，为0时表示不限制
+    /// \return size_type
+    ///
+    size_type get_max_memory_size() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_max_memory_size;
+    }
+
+    ///
+    /// set_max_memory_size
+    /// \brief 调整最大内存大小，为0时表示不限制
+    /// \param [in]: MemorySize 最大内存大小（以字节为单位）
+    /// \warning 此方法不会立即淘汰超出部分，超出部分由后续push（每次淘汰1个）或shrink逐步淘汰
+    ///
+    void set_max_memory_size(size_type MemorySize)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_max_memory_size = MemorySize;
+    }
+
+    ///
+    /// set_ghost_size
+    /// \brief 设置ghost表长度，ghost表记录最近被淘汰元素的key
+    /// \param [in]: GhostSize ghost表最大长度，为0时关闭ghost表
+    /// \details get未命中但key在ghost表中时，Stats::m_ghost_hit_cnt加1，
+    ///          可用于估计容量增加GhostSize个元素所能带来的命中收益
+    ///
+    void set_ghost_size(size_type GhostSize)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_max_ghost_size = GhostSize;
+        while (m_ghost_table.size() > m_max_ghost_size) {
+            _discard_one_ghost();
+        }
+    }
+
+    ///
+    /// shrink
+    /// \brief 淘汰超出size或内存限制的元素，单次至多淘汰MaxDiscard个
+    /// \param [in]: MaxDiscard 单次调用最多淘汰的元素个数
+    /// \return size_type 实际淘汰的元素个数
+    /// \details 用于限制下调后分批淘汰，每批之间释放锁，避免长时间阻塞其他操作
+    ///
+    size_type shrink(size_type MaxDiscard)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        size_type discarded = 0;
+        while (discarded < MaxDiscard && !m_list.empty() && _need_discard()) {
+            _discard_one_elem();
+            ++discarded;
+        }
+        return discarded;
+    }
+
+    ///
+    /// enable_filter
+    /// \brief 开启成员过滤器（计数bloom filter），exists/get可在不加锁的情况下拒绝不存在的key
+    /// \param [in]: Expected 预期元素个数（通常取最大元素个数），FalsePositiveRate 期望的误判率
+    /// \details 过滤器随push/淘汰同步增删，ghost表中的key也保留在过滤器中以便统计ghost命中；
+    ///          误判的key仍会加锁查找hash表，结果不受影响
+    /// \warning 被替换的过滤器可能仍被无锁查询读取，保留到容器析构才释放，不宜反复调用
+    ///
+    void enable_filter(size_type Expected, double FalsePositiveRate = 0.01)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        std::unique_ptr<filter_type> filter(new filter_type(Expected, FalsePositiveRate));
+        for (auto& item : m_list) {
+            filter->add(item.first);
+        }
+        for (auto& key : m_ghost_list) {
+            filter->add(key);
+        }
+        _install_filter(std::move(filter));
+    }
+
+    ///
+    /// open_cursor
+    /// \brief 创建按最近使用顺序（从最近到最久）分批遍历的游标
+    /// \return recency_cursor
+    /// \details 与next_chunk配合使用，每批之间释放锁，不会像拷贝构造那样长时间持有锁
+    ///
+    recency_cursor open_cursor()
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_cursors.push_front(cursor_state{m_list.begin(), 0});
+        return recency_cursor(this, m_cursors.begin());
+    }
+
+    ///
+    /// next_chunk
+    /// \brief 从游标当前位置起，按最近使用顺序取出至多MaxCount个元素，追加到out中
+    /// \param [in]: cursor, MaxCount [out]: out
+    /// \return size_type 本次取出的元素个数，为0时表示遍历结束
+    /// \details 允许两次调用之间并发修改容器：被淘汰或被移动到队头的元素不会使游标失效，游标自动后移；
+    ///          遍历开始后新压入或被访问的元素位于游标之前，不会被遍历到（弱一致性），每个元素至多遍历一次
+    ///
+    size_type next_chunk(recency_cursor& cursor, size_type MaxCount, std::vector<recency_entry>& out)
+    {
+        assert(cursor.m_cache == this);
+
+        std::lock_guard<std::mutex> lck (m_mutex);
+        cursor_state& state = *cursor.m_state;
+        size_type count = 0;
+        for (; count < MaxCount && state.m_pos != m_list.end(); ++count, ++state.m_pos) {
+            out.push_back(recency_entry{state.m_pos->first, state.m_pos->second, state.m_rank++});
+        }
+        return count;
+    }
+
+    ///
+    /// enable_hot_key_tracking
+    /// \brief 开启热点key统计（Space-Saving算法）
+    /// \param [in]: Capacity 计数器个数，SamplePeriod 采样周期，每SamplePeriod次get记录一次（权重为SamplePeriod）
+    /// \details 统计在get的锁内进行，时间复杂度O(log Capacity)；key分布均匀时几乎每次记录都会替换计数器，
+    ///          默认每16次get采样一次以免增加get的延迟，SamplePeriod为1时为精确的Space-Saving；
+    ///          被过滤器直接拒绝的get不计入统计
+    ///
+    void enable_hot_key_tracking(size_type Capacity, size_type SamplePeriod = 16)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_hot_keys.reset(new hot_key_tracker(Capacity));
+        m_hot_key_period = SamplePeriod == 0 ? 1 : SamplePeriod;
+        m_hot_key_tick = 0;
+    }
+
+    ///
+    /// get_hot_keys
+    /// \brief 获取估计get次数最多的N个key，按次数从大到小排列
+    /// \return std::vector<hot_key> 未开启统计时为空
+    ///
+    std::vector<hot_key> get_hot_keys(size_type N) const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        if (!m_hot_keys) {
+            return std::vector<hot_key>();
+        }
+        return m_hot_keys->top(N);
+    }
+
+    ///
+    /// set_discard_callback
+    /// \brief 设置元素被淘汰时的回调，用于写回脏数据、下沉到二级缓存等
+    /// \param [in]: callback 传入nullptr时取消回调
+    /// \warning 回调在容器的锁内调用，应尽快返回，且不能再调用此容器的任何方法；
+    ///          拷贝构造与赋值不会拷贝回调
+    ///
+    void set_discard_callback(const discard_callback& callback)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_discard_callback = callback;
     }
 
 public:
     LRU_cache<Key, Value>& operator=(const LRU_cache& from)
     {
-        BD_SLOCK(this->m_mutex);
-        this->m_list = from.m_list;
-        this->m_hash_table = from.m_hash_table;
+        if (this == &from) {
+            return *this;
+        }
 
-        this->m_max_size = from.m_max_size;
-        this->m_max_memory_size = from.m_max_memory_size;
+        std::unique_lock<std::mutex> lck_this (m_mutex, std::defer_lock);
+        std::unique_lock<std::mutex> lck_from (from.m_mutex, std::defer_lock);
+        std::lock(lck_this, lck_from);
 
-        this->m_get_cnt = from.m_stats.m_get_cnt;
-        this->m_hit_cnt = from.m_stats.m_hit_cnt;
+        _copy_from(from);
+        return *this;
     }
 
 private:
@@ -143,6 +539,78 @@ private:
         return _get_cache_size() * sizeof(value_type);
     }
 
+    ///
+    /// [内部方法] 在锁内压入k-v对，必要时淘汰1个元素
+    ///
+    void _push(const key_type& key, const value_ptr_type& value);
+
+    ///
+    /// [内部方法] 在锁内查找key，命中时移动至队头
+    ///
+    bool _get(const key_type& key, value_ptr_type& value);
+
+    ///
+    /// [内部方法] 在锁内发布统计值，只有锁内的线程写入，无需原子的读-改-写
+    ///
+    void _publish_stats()
+    {
+        m_published_get_cnt.store(m_stats.m_get_cnt, std::memory_order_relaxed);
+        m_published_hit_cnt.store(m_stats.m_hit_cnt, std::memory_order_release);
+    }
+
+    ///
+    /// [内部方法] 在锁内整体替换统计值（重置、拷贝），计数可能变小，
+    ///          以m_published_generation包围，无锁读取方据此丢弃跨越替换的读数
+    ///
+    void _republish_stats(size_type filter_reject_cnt)
+    {
+        uint32_t generation = m_published_generation.load(std::memory_order_relaxed);
+        m_published_generation.store(generation + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_filter_reject_cnt.store(filter_reject_cnt, std::memory_order_relaxed);
+        _publish_stats();
+        m_published_generation.store(generation + 2, std::memory_order_release);
+    }
+
+    ///
+    /// [内部方法] 无锁读取一对一致的命中次数与请求次数（含filter拒绝的次数），请求次数不小于命中次数
+    /// \return uint32_t 计数所属的代，每次整体替换统计值后改变
+    ///
+    uint32_t _load_published_stats(size_type& hit, size_type& get) const
+    {
+        while (true) {
+            uint32_t before = m_published_generation.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                // 先读命中次数，同一代内读到的请求次数不小于命中次数
+                hit = m_published_hit_cnt.load(std::memory_order_acquire);
+                get = m_published_get_cnt.load(std::memory_order_relaxed) +
+                    m_filter_reject_cnt.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_published_generation.load(std::memory_order_relaxed) == before) {
+                    return before;
+                }
+            }
+            // 只在与重置、拷贝并发时重试
+            std::this_thread::yield();
+        }
+    }
+
+    void _publish_size()
+    {
+        m_published_size.store(_get_cache_size(), std::memory_order_relaxed);
+    }
+
+    ///
+    /// [内部方法] 是否满足进行淘汰的条件
+    /// \return bool
+    ///
+    bool _need_discard() const
+    {
+        // 需同时满足size与内存大小两个条件才不会进行淘汰
+        return _get_cache_size() > m_max_size ||
+            (m_max_memory_size != 0 && _get_memory_size() > m_max_memory_size);
+    }
+
     ///
     /// [内部方法] 淘汰一个元素，时间复杂度O(1)
     ///
@@ -151,59 +619,221 @@ private:
         // std::list为双向链表，end()的时间复杂度为O(1)
         auto ite_list_last = m_list.end();
         ite_list_last--;
+        _advance_cursors(ite_list_last);
+        if (m_discard_callback) {
+            m_discard_callback(ite_list_last->first, ite_list_last->second);
+        }
+        _push_ghost(ite_list_last->first);
+        if (filter_type* filter = m_filter.load(std::memory_order_relaxed)) {
+            filter->remove(ite_list_last->first);
+        }
         m_hash_table.erase(ite_list_last->first);
+        _publish_size();
         m_list.erase(ite_list_last);
     }
+
+    ///
+    /// [内部方法] 元素ite即将被移动或删除，将指向它的游标后移
+    ///
+    void _advance_cursors(iterator ite)
+    {
+        if (m_cursors.empty()) {
+            return;
+        }
+        for (auto& state : m_cursors) {
+            if (state.m_pos == ite) {
+                ++state.m_pos;
+            }
+        }
+    }
+
+    ///
+    /// [内部方法] 关闭游标
+    ///
+    void _close_cursor(cursor_iterator state)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        m_cursors.erase(state);
+    }
+
+    ///
+    /// [内部方法] 将被淘汰元素的key记入ghost表，时间复杂度O(1)
+    ///
+    void _push_ghost(const key_type& key)
+    {
+        if (m_max_ghost_size == 0) {
+            return;
+        }
+        m_ghost_list.push_front(key);
+        m_ghost_table[key] = m_ghost_list.begin();
+        if (filter_type* filter = m_filter.load(std::memory_order_relaxed)) {
+            filter->add(key);
+        }
+        if (m_ghost_table.size() > m_max_ghost_size) {
+            _discard_one_ghost();
+        }
+    }
+
+    ///
+    /// [内部方法] 从ghost表中删除key（key重新被压入容器时调用）
+    ///
+    void _erase_ghost(const key_type& key)
+    {
+        if (m_ghost_table.empty()) {
+            return;
+        }
+        auto ite = m_ghost_table.find(key);
+        if (ite != m_ghost_table.end()) {
+            if (filter_type* filter = m_filter.load(std::memory_order_relaxed)) {
+                filter->remove(key);
+            }
+            m_ghost_list.erase(ite->second);
+            m_ghost_table.erase(ite);
+        }
+    }
+
+    ///
+    /// [内部方法] 淘汰ghost表中最旧的key
+    ///
+    void _discard_one_ghost()
+    {
+        auto ite_list_last = m_ghost_list.end();
+        ite_list_last--;
+        if (filter_type* filter = m_filter.load(std::memory_order_relaxed)) {
+            filter->remove(*ite_list_last);
+        }
+        m_ghost_table.erase(*ite_list_last);
+        m_ghost_list.erase(ite_list_last);
+    }
+
+    ///
+    /// [内部方法] 换上新的过滤器，调用方需持有锁
+    /// \warning 旧的过滤器可能仍被无锁查询读取，不能释放，保留到容器析构
+    ///
+    void _install_filter(std::unique_ptr<filter_type> filter)
+    {
+        m_filter.store(filter.get(), std::memory_order_release);
+        m_filter_storage.push_back(std::move(filter));
+    }
+
+    ///
+    /// [内部方法] 拷贝from的内容，调用方需持有双方的锁
+    /// \warning hash表中保存的是list的迭代器，不能直接拷贝，需根据新的list重建
+    ///
+    void _copy_from(const LRU_cache& from)
+    {
+        m_list = from.m_list;
+        m_hash_table.clear();
+        for (auto ite = m_list.begin(); ite != m_list.end(); ++ite) {
+            m_hash_table[ite->first] = ite;
+        }
+
+        m_ghost_list = from.m_ghost_list;
+        m_ghost_table.clear();
+        for (auto ite = m_ghost_list.begin(); ite != m_ghost_list.end(); ++ite) {
+            m_ghost_table[*ite] = ite;
+        }
+
+        m_max_size = from.m_max_size;
+        m_max_memory_size = from.m_max_memory_size;
+        m_max_ghost_size = from.m_max_ghost_size;
+
+        // 已打开的游标指向旧的list，拷贝后直接结束
+        for (auto& state : m_cursors) {
+            state.m_pos = m_list.end();
+        }
+
+        m_hot_keys.reset(from.m_hot_keys ? new hot_key_tracker(*from.m_hot_keys) : nullptr);
+        m_hot_key_period = from.m_hot_key_period;
+        m_hot_key_tick = from.m_hot_key_tick;
+
+        // 无锁查询可能正在读取当前的过滤器：结构相同时原地复制计数，否则换上新的过滤器，旧的保留到析构
+        filter_type* from_filter = from.m_filter.load(std::memory_order_relaxed);
+        filter_type* filter = m_filter.load(std::memory_order_relaxed);
+        if (!from_filter) {
+            m_filter.store(nullptr, std::memory_order_release);
+        } else if (!filter || !filter->assign(*from_filter)) {
+            _install_filter(std::unique_ptr<filter_type>(new filter_type(*from_filter)));
+        }
+
+        m_stats = from.m_stats;
+        _republish_stats(from.m_filter_reject_cnt.load(std::memory_order_relaxed));
+        _publish_size();
+    }
 };
 
 template <typename Key, typename Value>
 LRU_cache<Key, Value>::LRU_cache(size_t Size) :
     m_max_size(Size),
-    m_max_memory_size(0)
+    m_max_memory_size(0),
+    m_max_ghost_size(0),
+    m_filter(nullptr),
+    m_filter_reject_cnt(0),
+    m_hot_key_period(1),
+    m_hot_key_tick(0),
+    m_published_get_cnt(0),
+    m_published_hit_cnt(0),
+    m_published_size(0),
+    m_published_generation(0)
 {
     m_stats.m_get_cnt = 0;
     m_stats.m_hit_cnt = 0;
+    m_stats.m_ghost_hit_cnt = 0;
+    m_stats.m_filter_reject_cnt = 0;
 }
 
 template <typename Key, typename Value>
 LRU_cache<Key, Value>::LRU_cache(size_type Size, size_type MemorySize) :
     m_max_size(Size),
-    m_max_memory_size(MemorySize)
+    m_max_memory_size(MemorySize),
+    m_max_ghost_size(0),
+    m_filter(nullptr),
+    m_filter_reject_cnt(0),
+    m_hot_key_period(1),
+    m_hot_key_tick(0),
+    m_published_get_cnt(0),
+    m_published_hit_cnt(0),
+    m_published_size(0),
+    m_published_generation(0)
 {
     m_stats.m_get_cnt = 0;
     m_stats.m_hit_cnt = 0;
+    m_stats.m_ghost_hit_cnt = 0;
+    m_stats.m_filter_reject_cnt = 0;
 }
 
 template <typename Key, typename Value>
-LRU_cache<Key, Value>::LRU_cache(const LRU_cache& from)
+LRU_cache<Key, Value>::LRU_cache(const LRU_cache& from) :
+    m_filter(nullptr)
 {
-    std::lock_guard<std::mutex> lck (m_mutex);
-    this->m_list = from.m_list;
-    this->m_hash_table = from.m_hash_table;
-
-    this->m_max_size = from.m_max_size;
-    this->m_max_memory_size = from.m_max_memory_size;
-
-    this->m_get_cnt = from.m_stats.m_get_cnt;
-    this->m_hit_cnt = from.m_stats.m_hit_cnt;
+    std::lock_guard<std::mutex> lck (from.m_mutex);
+    _copy_from(from);
 }
 
 template <typename Key, typename Value>
 void LRU_cache<Key, Value>::push(const key_type& key, const value_ptr_type& value) {
     std::lock_guard<std::mutex> lck (m_mutex);
+    _push(key, value);
+}
 
+template <typename Key, typename Value>
+void LRU_cache<Key, Value>::_push(const key_type& key, const value_ptr_type& value) {
     auto ite = m_hash_table.find(key);
     if (ite == m_hash_table.end()) {
+        _erase_ghost(key);
+        if (filter_type* filter = m_filter.load(std::memory_order_relaxed)) {
+            filter->add(key);
+        }
         m_list.push_front({key, value});
-        m_hash_table[key] = m_list.begin();
+        m_hash_table.insert(key, m_list.begin());
+        _publish_size();
     } else {
         ite->second->second = value;
+        _advance_cursors(ite->second);
         m_list.splice(m_list.begin(), m_list, ite->second);
     }
 
-    // 需同时满足size与内存大小两个条件才不会进行淘汰
-    if (_get_cache_size() > m_max_size ||
-        (m_max_memory_size != 0 && _get_memory_size() > m_max_memory_size)) {
+    if (_need_discard()) {
         _discard_one_elem();
     }
 
@@ -212,16 +842,57 @@ void LRU_cache<Key, Value>::push(const key_type& key, const value_ptr_type& valu
 template <typename Key, typename Value>
 bool LRU_cache<Key, Value>::get(const key_type& key, value_ptr_type& value)
 {
+    // 过滤器判定不存在时无需加锁
+    filter_type* filter = m_filter.load(std::memory_order_acquire);
+    if (filter && !filter->may_contain(key)) {
+        m_filter_reject_cnt.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
     std::lock_guard<std::mutex> lck (m_mutex);
+    return _get(key, value);
+}
 
+template <typename Key, typename Value>
+bool LRU_cache<Key, Value>::try_get(const key_type& key, value_ptr_type& value, bool& busy)
+{
+    busy = false;
+    filter_type* filter = m_filter.load(std::memory_order_acquire);
+    if (filter && !filter->may_contain(key)) {
+        m_filter_reject_cnt.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lck (m_mutex, std::try_to_lock);
+    if (!lck.owns_lock()) {
+        busy = true;
+        return false;
+    }
+    return _get(key, value);
+}
+
+template <typename Key, typename Value>
+bool LRU_cache<Key, Value>::_get(const key_type& key, value_ptr_type& value)
+{
     m_stats.m_get_cnt++;
+    m_published_get_cnt.store(m_stats.m_get_cnt, std::memory_order_relaxed);
+    if (m_hot_keys && ++m_hot_key_tick == m_hot_key_period) {
+        m_hot_key_tick = 0;
+        m_hot_keys->offer(key, m_hot_key_period);
+    }
+
     auto ite = m_hash_table.find(key);
 
     if (ite == m_hash_table.end()) {
+        if (!m_ghost_table.empty() && m_ghost_table.find(key) != m_ghost_table.end()) {
+            m_stats.m_ghost_hit_cnt++;
+        }
         return false;
     }
 
     m_stats.m_hit_cnt++;
+    m_published_hit_cnt.store(m_stats.m_hit_cnt, std::memory_order_release);
+    _advance_cursors(ite->second);
     m_list.splice(m_list.begin(), m_list, ite->second);
 
     value = ite->second->second;
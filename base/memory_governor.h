@@ -0,0 +1,464 @@
+#ifndef COMMON_BASE_MEMORY_GOVERNOR_H
+#define COMMON_BASE_MEMORY_GOVERNOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lru_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 受memory_governor管理的缓存接口
+/// \details LRU_cache为模板类，不同实例化之间没有公共基类，通过此接口统一管理
+///
+class governed_cache
+{
+public:
+    using size_type = size_t;
+
+    virtual ~governed_cache() {}
+
+    /// 当前占用内存大小（以字节为单位）
+    virtual size_type memory_size() const = 0;
+
+    /// 当前内存上限（以字节为单位）
+    virtual size_type memory_limit() const = 0;
+
+    /// 调整内存上限，不会立即淘汰
+    virtual void set_memory_limit(size_type limit) = 0;
+
+    /// 单个元素的内存大小（以字节为单位）
+    virtual size_type entry_size() const = 0;
+
+    /// 设置ghost表长度（以元素个数为单位）
+    virtual void set_ghost_size(size_type size) = 0;
+
+    /// 累计的ghost命中次数
+    virtual size_type ghost_hit_count() const = 0;
+
+    /// 淘汰超出上限的元素，单次至多淘汰max_discard个，返回实际淘汰个数
+    virtual size_type shrink(size_type max_discard) = 0;
+};
+
+///
+/// LRU_cache到governed_cache的适配
+///
+template <typename Key, typename Value>
+class LRU_cache_governed : public governed_cache
+{
+public:
+    using cache_type    = LRU_cache<Key, Value>;
+    using cache_ptr     = std::shared_ptr<cache_type>;
+
+private:
+    cache_ptr   m_cache;
+
+public:
+    explicit LRU_cache_governed(const cache_ptr& cache) : m_cache(cache) {}
+
+    size_type memory_size() const override { return m_cache->get_memory_size(); }
+    size_type memory_limit() const override { return m_cache->get_max_memory_size(); }
+    void set_memory_limit(size_type limit) override { m_cache->set_max_memory_size(limit); }
+    size_type entry_size() const override { return sizeof(Value); }
+    void set_ghost_size(size_type size) override { m_cache->set_ghost_size(size); }
+    size_type ghost_hit_count() const override { return m_cache->get_stats().m_ghost_hit_cnt; }
+    size_type shrink(size_type max_discard) override { return m_cache->shrink(max_discard); }
+};
+
+///
+/// 进程级内存管理器：多个缓存共享一个总的内存预算（以字节为单位）
+/// \details 各缓存的内存上限之和始终不超过总预算，且每个缓存至少保留Options::m_min_bytes，
+///          预算不足时拒绝注册。rebalance根据各缓存的ghost命中
+///          （即多给一个step的内存可多获得的命中次数）将内存从边际收益低的缓存移向收益高的缓存；
+///          上限下调后由evict_step分批淘汰，每批之间释放缓存的锁，不会长时间阻塞业务线程
+///
+class memory_governor
+{
+public:
+    using size_type     = size_t;
+    using handle_type   = size_t;
+    using cache_ptr     = std::shared_ptr<governed_cache>;
+
+    /// register_cache失败时返回的句柄；使用函数而非静态常量成员，按引用传递时无需类外定义
+    static constexpr handle_type invalid_handle()
+    {
+        return static_cast<handle_type>(-1);
+    }
+
+    struct Options {
+        size_type   m_step_bytes;       // 每次rebalance在一对缓存间移动的内存大小，同时决定ghost表长度
+        size_type   m_min_bytes;        // 每个缓存至少保留的内存大小
+        size_type   m_evict_batch;      // evict_step中每个缓存每批最多淘汰的元素个数
+    };
+
+private:
+    struct Entry {
+        cache_ptr   m_cache;
+        size_type   m_last_ghost_hit;   // 上次rebalance时的ghost命中次数
+    };
+
+    mutable std::mutex              m_mutex;
+    std::map<handle_type, Entry>    m_caches;
+    handle_type                     m_next_handle;
+
+    size_type                       m_budget;           // 总内存预算
+    Options                         m_options;
+
+    // 后台线程
+    std::thread                     m_thread;
+    std::mutex                      m_thread_mutex;
+    std::condition_variable         m_thread_cond;
+    bool                            m_running;
+
+public:
+    memory_governor() = delete;
+    memory_governor(const memory_governor&) = delete;
+    memory_governor& operator=(const memory_governor&) = delete;
+
+    ///
+    /// construct
+    /// \param [Budget] 总内存预算（以字节为单位）
+    ///
+    explicit memory_governor(size_type Budget);
+
+    ///
+    /// construct
+    /// \param [Budget] 总内存预算（以字节为单位），[options] 调节参数
+    ///
+    memory_governor(size_type Budget, const Options& options);
+
+    ~memory_governor()
+    {
+        stop();
+    }
+
+public:
+    ///
+    /// register_cache
+    /// \brief 将LRU_cache注册到管理器
+    /// \param [in]: cache
+    /// \return handle_type 用于unregister_cache的句柄，预算不足以使每个缓存保留Options::m_min_bytes时
+    ///                     不注册并返回invalid_handle()
+    /// \details 已有缓存的上限按比例缩小（不低于m_min_bytes，差额由上限最大的缓存承担），
+    ///          新缓存获得所有未分配的预算，约为 budget / n
+    /// \warning 管理器持有cache的shared_ptr，需调用unregister_cache释放
+    ///
+    template <typename Key, typename Value>
+    handle_type register_cache(const std::shared_ptr<LRU_cache<Key, Value>>& cache)
+    {
+        return register_cache(cache_ptr(new LRU_cache_governed<Key, Value>(cache)));
+    }
+
+    ///
+    /// register_cache
+    /// \brief 注册任意实现了governed_cache接口的缓存
+    ///
+    handle_type register_cache(const cache_ptr& cache);
+
+    ///
+    /// unregister_cache
+    /// \brief 取消注册，释放的内存平均分给其余缓存，余数也分配出去，上限之和仍等于总预算
+    /// \param [in]: handle register_cache的返回值
+    /// \return bool [true]: 取消成功 [false]: 句柄不存在
+    ///
+    bool unregister_cache(handle_type handle);
+
+    ///
+    /// rebalance
+    /// \brief 根据上次rebalance以来的ghost命中，在缓存间移动内存上限
+    /// \return size_type 本次移动的内存总量（以字节为单位）
+    /// \warning 只调整上限，不进行淘汰，淘汰由evict_step完成
+    ///
+    size_type rebalance();
+
+    ///
+    /// evict_step
+    /// \brief 对每个超出上限的缓存淘汰至多Options::m_evict_batch个元素
+    /// \return size_type 本次淘汰的元素总数，为0时表示所有缓存均未超出上限
+    ///
+    size_type evict_step();
+
+    ///
+    /// start
+    /// \brief 启动后台线程，每隔interval执行一次rebalance，并分批淘汰直到所有缓存不超出上限
+    ///
+    void start(std::chrono::milliseconds interval);
+
+    ///
+    /// stop
+    /// \brief 停止后台线程
+    ///
+    void stop();
+
+    ///
+    /// get_budget
+    /// \return size_type 总内存预算
+    ///
+    size_type get_budget() const
+    {
+        return m_budget;
+    }
+
+    ///
+    /// get_memory_limit
+    /// \return size_type handle对应缓存的当前内存上限，句柄不存在时返回0
+    ///
+    size_type get_memory_limit(handle_type handle) const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        auto ite = m_caches.find(handle);
+        return ite == m_caches.end() ? 0 : ite->second.m_cache->memory_limit();
+    }
+
+private:
+    ///
+    /// [内部方法] 获取所有缓存的拷贝，使淘汰在管理器的锁之外进行
+    ///
+    std::vector<cache_ptr> _get_caches() const
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        std::vector<cache_ptr> caches;
+        caches.reserve(m_caches.size());
+        for (auto& item : m_caches) {
+            caches.push_back(item.second.m_cache);
+        }
+        return caches;
+    }
+
+    ///
+    /// [内部方法] 总预算中尚未分配给任何缓存的部分，调用方需持有m_mutex
+    ///
+    size_type _free_bytes() const
+    {
+        size_type used = 0;
+        for (auto& item : m_caches) {
+            used += item.second.m_cache->memory_limit();
+        }
+        return used < m_budget ? m_budget - used : 0;
+    }
+
+    ///
+    /// [内部方法] ghost表长度，对应m_step_bytes可容纳的元素个数
+    ///
+    size_type _ghost_size(const cache_ptr& cache) const
+    {
+        size_type entry = std::max<size_type>(cache->entry_size(), 1);
+        return std::max<size_type>(m_options.m_step_bytes / entry, 1);
+    }
+
+    void _run(std::chrono::milliseconds interval);
+};
+
+inline memory_governor::memory_governor(size_type Budget) :
+    m_next_handle(0),
+    m_budget(Budget),
+    m_running(false)
+{
+    m_options.m_step_bytes = std::max<size_type>(Budget / 64, 1);
+    m_options.m_min_bytes = std::max<size_type>(Budget / 1024, 1);
+    m_options.m_evict_batch = 1024;
+}
+
+inline memory_governor::memory_governor(size_type Budget, const Options& options) :
+    m_next_handle(0),
+    m_budget(Budget),
+    m_options(options),
+    m_running(false)
+{
+    if (m_options.m_step_bytes == 0) {
+        m_options.m_step_bytes = 1;
+    }
+    if (m_options.m_min_bytes == 0) {
+        m_options.m_min_bytes = 1;
+    }
+    if (m_options.m_evict_batch == 0) {
+        m_options.m_evict_batch = 1;
+    }
+}
+
+inline memory_governor::handle_type memory_governor::register_cache(const cache_ptr& cache)
+{
+    std::lock_guard<std::mutex> lck (m_mutex);
+
+    size_type n = m_caches.size() + 1;
+    if (m_budget / n < m_options.m_min_bytes) {
+        return invalid_handle();
+    }
+    size_type share = m_budget / n;
+
+    // 已有缓存的上限按 (n-1)/n 缩小，腾出的空间给新缓存
+    for (auto& item : m_caches) {
+        governed_cache& c = *item.second.m_cache;
+        size_type limit = c.memory_limit() / n * (n - 1);
+        c.set_memory_limit(std::max(limit, m_options.m_min_bytes));
+    }
+
+    // 部分缓存已处于下限而腾不出空间时，差额从上限最大的缓存中扣除
+    size_type free = _free_bytes();
+    while (free < share) {
+        governed_cache* largest = nullptr;
+        for (auto& item : m_caches) {
+            governed_cache& c = *item.second.m_cache;
+            if (c.memory_limit() > m_options.m_min_bytes &&
+                (largest == nullptr || c.memory_limit() > largest->memory_limit())) {
+                largest = &c;
+            }
+        }
+        if (largest == nullptr) {
+            break;
+        }
+        size_type take = std::min(share - free, largest->memory_limit() - m_options.m_min_bytes);
+        largest->set_memory_limit(largest->memory_limit() - take);
+        free += take;
+    }
+
+    // 未分配的预算全部给新缓存，上限之和等于总预算
+    cache->set_memory_limit(free);
+    cache->set_ghost_size(_ghost_size(cache));
+
+    handle_type handle = m_next_handle++;
+    m_caches[handle] = Entry{cache, cache->ghost_hit_count()};
+    return handle;
+}
+
+inline bool memory_governor::unregister_cache(handle_type handle)
+{
+    std::lock_guard<std::mutex> lck (m_mutex);
+
+    auto ite = m_caches.find(handle);
+    if (ite == m_caches.end()) {
+        return false;
+    }
+
+    ite->second.m_cache->set_ghost_size(0);
+    m_caches.erase(ite);
+
+    if (!m_caches.empty()) {
+        // 平均分配，除不尽的部分逐个分给前面的缓存
+        size_type free = _free_bytes();
+        size_type share = free / m_caches.size();
+        size_type remainder = free % m_caches.size();
+        for (auto& item : m_caches) {
+            governed_cache& c = *item.second.m_cache;
+            c.set_memory_limit(c.memory_limit() + share + (remainder > 0 ? 1 : 0));
+            if (remainder > 0) {
+                --remainder;
+            }
+        }
+    }
+    return true;
+}
+
+inline memory_governor::size_type memory_governor::rebalance()
+{
+    std::lock_guard<std::mutex> lck (m_mutex);
+
+    if (m_caches.size() < 2) {
+        for (auto& item : m_caches) {
+            item.second.m_last_ghost_hit = item.second.m_cache->ghost_hit_count();
+        }
+        return 0;
+    }
+
+    // 边际收益：上次rebalance以来，多给m_step_bytes内存可多获得的命中次数
+    std::vector<std::pair<size_type, Entry*>> gains;
+    gains.reserve(m_caches.size());
+    for (auto& item : m_caches) {
+        Entry& entry = item.second;
+        size_type ghost_hit = entry.m_cache->ghost_hit_count();
+        size_type gain = ghost_hit >= entry.m_last_ghost_hit ? ghost_hit - entry.m_last_ghost_hit : 0;
+        entry.m_last_ghost_hit = ghost_hit;
+        gains.push_back({gain, &entry});
+    }
+
+    std::sort(gains.begin(), gains.end(),
+              [](const std::pair<size_type, Entry*>& a, const std::pair<size_type, Entry*>& b) {
+                  return a.first < b.first;
+              });
+
+    // 收益最低的与收益最高的配对，依次向内收缩
+    size_type moved = 0;
+    size_type i = 0, j = gains.size() - 1;
+    while (i < j && gains[i].first < gains[j].first) {
+        governed_cache& donor = *gains[i].second->m_cache;
+        governed_cache& receiver = *gains[j].second->m_cache;
+
+        size_type donor_limit = donor.memory_limit();
+        if (donor_limit > m_options.m_min_bytes) {
+            size_type step = std::min(m_options.m_step_bytes, donor_limit - m_options.m_min_bytes);
+            donor.set_memory_limit(donor_limit - step);
+            receiver.set_memory_limit(receiver.memory_limit() + step);
+            moved += step;
+        }
+        ++i;
+        --j;
+    }
+    return moved;
+}
+
+inline memory_governor::size_type memory_governor::evict_step()
+{
+    // 淘汰时不持有管理器的锁，每个缓存每批只持有自己的锁
+    std::vector<cache_ptr> caches = _get_caches();
+
+    size_type discarded = 0;
+    for (auto& cache : caches) {
+        discarded += cache->shrink(m_options.m_evict_batch);
+    }
+    return discarded;
+}
+
+inline void memory_governor::start(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lck (m_thread_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&memory_governor::_run, this, interval);
+}
+
+inline void memory_governor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lck (m_thread_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_thread_cond.notify_all();
+    m_thread.join();
+}
+
+inline void memory_governor::_run(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lck (m_thread_mutex);
+    while (m_running) {
+        m_thread_cond.wait_for(lck, interval);
+        if (!m_running) {
+            break;
+        }
+
+        lck.unlock();
+        rebalance();
+        // 分批淘汰，批与批之间让出CPU
+        while (evict_step() != 0) {
+            std::this_thread::yield();
+        }
+        lck.lock();
+    }
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef COMMON_BASE_OBJECT_POOL_H
+#define COMMON_BASE_OBJECT_POOL_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "lockfree_circular_queue.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 有界对象池，回收对象以避免频繁分配与释放
+/// \details 归还的对象先放入线程本地缓存，本地缓存满时将一半转移到共享的无锁环状队列，
+///          队列也满时直接释放；获取对象时依次查找本地缓存、共享队列，都没有时才新建；
+///          make_shared/make_unique返回的智能指针在释放时自动将对象归还到池中
+/// \param [T] 对象类型，[BufSize] 共享队列容量，需为2的幂
+/// \warning make_shared仍会为每个对象分配shared_ptr的控制块；
+///          每个线程的本地缓存只绑定最近归还对象的那个池，同一线程交替使用多个同类型的池时本地缓存效果下降；
+///          本地缓存不延长池的生命周期，池析构后其他线程本地缓存中的对象在该线程下次使用同类型的池或退出时释放
+///
+template<typename T, size_t BufSize = 1024>
+class object_pool {
+public:
+    using value_type        = T;
+    using size_type         = size_t;
+
+    /// 对象归还到池中之前调用，用于清空对象状态
+    using reset_hook        = std::function<void(T&)>;
+    /// 池中没有空闲对象时调用，用于新建对象
+    using factory           = std::function<T*()>;
+
+    struct Stats {
+        size_type   m_create_cnt;   // 新建的对象个数
+        size_type   m_reuse_cnt;    // 复用的次数
+        size_type   m_destroy_cnt;  // 池满时释放的对象个数
+    };
+
+private:
+    static const size_type  kLocalCacheSize = 32;
+
+    struct pool_core {
+        lockfree_circular_queue<T*, BufSize>    m_free;
+        reset_hook                              m_reset;
+        factory                                 m_factory;
+        std::atomic<size_type>                  m_create_cnt;
+        std::atomic<size_type>                  m_reuse_cnt;
+        std::atomic<size_type>                  m_destroy_cnt;
+
+        ~pool_core() {
+            T* obj;
+            while (m_free.try_pop(obj)) {
+                delete obj;
+            }
+        }
+
+        void give_back(T* obj) {
+            if (!m_free.try_push(obj)) {
+                m_destroy_cnt.fetch_add(1, std::memory_order_relaxed);
+                delete obj;
+            }
+        }
+    };
+
+    using core_ptr          = std::shared_ptr<pool_core>;
+    using core_weak_ptr     = std::weak_ptr<pool_core>;
+
+    /// 线程本地缓存，只持有所绑定池的弱引用，线程退出时将对象归还
+    struct local_cache {
+        core_weak_ptr   m_core;
+        T*              m_items[kLocalCacheSize];
+        size_type       m_count = 0;
+
+        ~local_cache() {
+            flush(0);
+        }
+
+        /// 是否绑定core，只比较控制块，不修改引用计数
+        bool bound(const core_ptr& core) const {
+            return !m_core.owner_before(core) && !core.owner_before(m_core);
+        }
+
+        /// 将对象转移到共享队列，直到本地只剩Keep个；所绑定的池已析构时直接释放
+        void flush(size_type Keep) {
+            core_ptr core = m_core.lock();
+            while (m_count > Keep) {
+                T* obj = m_items[--m_count];
+                if (core) {
+                    core->give_back(obj);
+                } else {
+                    delete obj;
+                }
+            }
+        }
+    };
+
+    core_ptr    m_core;
+
+public:
+    ///
+    /// 归还对象的删除器，持有池的引用，池先于对象析构时仍可安全归还
+    ///
+    struct deleter {
+        core_ptr m_core;
+
+        void operator()(T* obj) const {
+            // 只剩删除器持有引用时池已析构
+            object_pool::_release(m_core, obj, m_core.use_count() == 1);
+        }
+    };
+
+    using unique_ptr_type   = std::unique_ptr<T, deleter>;
+
+    ///
+    /// construct
+    /// \param [reset] 归还前调用的重置函数，可为nullptr，[create] 新建对象的函数，为nullptr时使用new T()
+    ///
+    explicit object_pool(const reset_hook& reset = nullptr, const factory& create = nullptr) :
+        m_core(new pool_core()) {
+        m_core->m_reset = reset;
+        m_core->m_factory = create;
+        m_core->m_create_cnt.store(0, std::memory_order_relaxed);
+        m_core->m_reuse_cnt.store(0, std::memory_order_relaxed);
+        m_core->m_destroy_cnt.store(0, std::memory_order_relaxed);
+    }
+
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    ~object_pool() {
+        // 当前线程的本地缓存绑定此池时先归还，池没有其他引用时其中的对象随池一并释放
+        local_cache& local = _local();
+        if (local.bound(m_core)) {
+            local.flush(0);
+            local.m_core.reset();
+        }
+    }
+
+public:
+    ///
+    /// acquire
+    /// \brief 获取一个对象，需通过release归还
+    ///
+    T* acquire();
+
+    ///
+    /// release
+    /// \brief 归还acquire获取的对象
+    ///
+    void release(T* obj) {
+        _release(m_core, obj);
+    }
+
+    ///
+    /// make_unique
+    /// \brief 获取一个对象，unique_ptr释放时自动归还
+    ///
+    unique_ptr_type make_unique() {
+        return unique_ptr_type(acquire(), deleter{m_core});
+    }
+
+    ///
+    /// make_shared
+    /// \brief 获取一个对象，最后一个shared_ptr释放时自动归还，可直接作为LRU_cache的value
+    ///
+    std::shared_ptr<T> make_shared() {
+        return std::shared_ptr<T>(acquire(), deleter{m_core});
+    }
+
+    ///
+    /// idle_size
+    /// \return size_type 共享队列中空闲对象的个数（近似值，不包括线程本地缓存）
+    ///
+    size_type idle_size() const {
+        return m_core->m_free.size();
+    }
+
+    Stats get_stats() const {
+        Stats stats;
+        stats.m_create_cnt = m_core->m_create_cnt.load(std::memory_order_relaxed);
+        stats.m_reuse_cnt = m_core->m_reuse_cnt.load(std::memory_order_relaxed);
+        stats.m_destroy_cnt = m_core->m_destroy_cnt.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    static local_cache& _local() {
+        static thread_local local_cache cache;
+        return cache;
+    }
+
+    ///
+    /// [内部方法] 归还对象
+    /// \param [Last] core是否只剩调用方持有的引用，为true时不放入本地缓存，直接归还并随池一并释放
+    ///
+    static void _release(const core_ptr& core, T* obj, bool Last = false);
+};
+
+template<typename T, size_t BufSize>
+T* object_pool<T, BufSize>::acquire() {
+    local_cache& local = _local();
+    T* obj = nullptr;
+    if (local.bound(m_core) && local.m_count != 0) {
+        obj = local.m_items[--local.m_count];
+    } else if (!m_core->m_free.try_pop(obj)) {
+        m_core->m_create_cnt.fetch_add(1, std::memory_order_relaxed);
+        return m_core->m_factory ? m_core->m_factory() : new T();
+    }
+
+    m_core->m_reuse_cnt.fetch_add(1, std::memory_order_relaxed);
+    return obj;
+}
+
+template<typename T, size_t BufSize>
+void object_pool<T, BufSize>::_release(const core_ptr& core, T* obj, bool Last) {
+    if (obj == nullptr) {
+        return;
+    }
+    if (core->m_reset) {
+        core->m_reset(*obj);
+    }
+
+    local_cache& local = _local();
+    if (Last) {
+        // 连同本地缓存中的对象一并归还，随池释放
+        if (local.bound(core)) {
+            local.flush(0);
+        }
+        core->give_back(obj);
+        return;
+    }
+
+    if (!local.bound(core)) {
+        // 本地缓存改为绑定当前池，原有对象归还给原来的池
+        local.flush(0);
+        local.m_core = core;
+    }
+
+    if (local.m_count == kLocalCacheSize) {
+        local.flush(kLocalCacheSize / 2);
+    }
+    local.m_items[local.m_count++] = obj;
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef COMMON_BASE_SPACE_SAVING_H
+#define COMMON_BASE_SPACE_SAVING_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "flat_hash_index.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// Space-Saving算法统计出现次数最多的key（heavy hitter）
+/// \details 只保留Capacity个计数器，计数器满时新key替换计数最小的key，并继承其计数（记为误差上界）；
+///          出现次数超过 总次数 / Capacity 的key一定在结果中；
+///          计数器按最小堆组织，offer的时间复杂度为O(log Capacity)
+/// \warning 非线程安全
+///
+template <typename Key, typename Hash = std::hash<Key>>
+class space_saving
+{
+public:
+    using key_type      = Key;
+    using size_type     = size_t;
+    using count_type    = size_t;
+
+    struct Counter {
+        key_type    m_key;
+        count_type  m_count;    // 估计的出现次数，不小于真实值
+        count_type  m_error;    // 估计的误差上界，真实值不小于m_count - m_error
+    };
+
+private:
+    std::vector<Counter>                            m_heap;     // 按m_count的最小堆
+    flat_hash_index<key_type, size_type, Hash>      m_index;    // key在m_heap中的下标
+    size_type                                       m_capacity;
+    count_type                                      m_total;    // 总次数
+
+public:
+    space_saving() = delete;
+
+    ///
+    /// construct
+    /// \param [Capacity] 计数器个数
+    ///
+    explicit space_saving(size_type Capacity) :
+        m_capacity(Capacity == 0 ? 1 : Capacity),
+        m_total(0)
+    {
+        m_heap.reserve(m_capacity);
+        m_index.reserve(m_capacity);
+    }
+
+public:
+    ///
+    /// offer
+    /// \brief 记录key出现Count次
+    ///
+    void offer(const key_type& key, count_type Count = 1)
+    {
+        m_total += Count;
+
+        auto ite = m_index.find(key);
+        if (ite != m_index.end()) {
+            m_heap[ite->second].m_count += Count;
+            _sift_down(ite->second);
+            return;
+        }
+
+        if (m_heap.size() < m_capacity) {
+            m_heap.push_back(Counter{key, Count, 0});
+            m_index.insert(key, m_heap.size() - 1);
+            _sift_up(m_heap.size() - 1);
+            return;
+        }
+
+        // 替换计数最小的key
+        Counter& min = m_heap[0];
+        m_index.erase(min.m_key);
+        min.m_error = min.m_count;
+        min.m_count += Count;
+        min.m_key = key;
+        m_index.insert(key, 0);
+        _sift_down(0);
+    }
+
+    ///
+    /// top
+    /// \brief 获取估计出现次数最多的N个key，按次数从大到小排列
+    ///
+    std::vector<Counter> top(size_type N) const
+    {
+        std::vector<Counter> result(m_heap);
+        N = std::min(N, result.size());
+        std::partial_sort(result.begin(), result.begin() + N, result.end(),
+                          [](const Counter& a, const Counter& b) { return a.m_count > b.m_count; });
+        result.resize(N);
+        return result;
+    }
+
+    ///
+    /// total
+    /// \return count_type 总次数
+    ///
+    count_type total() const
+    {
+        return m_total;
+    }
+
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+
+    void clear()
+    {
+        m_heap.clear();
+        m_index.clear();
+        m_total = 0;
+    }
+
+private:
+    void _swap(size_type a, size_type b)
+    {
+        std::swap(m_heap[a], m_heap[b]);
+        m_index.find(m_heap[a].m_key)->second = a;
+        m_index.find(m_heap[b].m_key)->second = b;
+    }
+
+    void _sift_up(size_type pos)
+    {
+        while (pos > 0) {
+            size_type parent = (pos - 1) / 2;
+            if (m_heap[parent].m_count <= m_heap[pos].m_count) {
+                break;
+            }
+            _swap(parent, pos);
+            pos = parent;
+        }
+    }
+
+    void _sift_down(size_type pos)
+    {
+        size_type n = m_heap.size();
+        while (true) {
+            size_type min = pos;
+            size_type left = pos * 2 + 1;
+            size_type right = left + 1;
+            if (left < n && m_heap[left].m_count < m_heap[min].m_count) {
+                min = left;
+            }
+            if (right < n && m_heap[right].m_count < m_heap[min].m_count) {
+                min = right;
+            }
+            if (min == pos) {
+                break;
+            }
+            _swap(min, pos);
+            pos = min;
+        }
+    }
+};
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
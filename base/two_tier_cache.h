@@ -0,0 +1,316 @@
+#ifndef COMMON_BASE_TWO_TIER_CACHE_H
+#define COMMON_BASE_TWO_TIER_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "file_victim_tier.h"
+#include "lru_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 内存 + 本地文件的两级缓存
+/// \details 内存层为LRU_cache，被淘汰的元素经编解码器写入file_victim_tier；
+///          内存层未命中时从文件层读取，命中后提升回内存层并从文件层删除；
+///          淘汰在LRU_cache的锁内发生，此时只将元素放入待写队列，文件写入于锁外进行：
+///          没有其他线程在写入时由push自己写入，否则交给正在写入的线程一并写入，push不等待；
+///          写入完成前待写队列中的元素同样可以读到；
+///          提升只在内存层仍无此key、且读取以来没有对此key的push时进行，不会用旧值覆盖并发push的新值
+/// \param [ValueCodec] value的编解码器，[KeyCodec] key的编解码器，见file_victim_tier
+///
+template <typename Key, typename Value,
+          typename ValueCodec = pod_codec<Value>, typename KeyCodec = pod_codec<Key>>
+class two_tier_cache
+{
+public:
+    using key_type          = Key;
+    using value_type        = Value;
+    using cache_type        = LRU_cache<Key, Value>;
+    using tier_type         = file_victim_tier<Key, Value, ValueCodec, KeyCodec>;
+    using value_ptr_type    = typename cache_type::value_ptr_type;
+    using size_type         = size_t;
+
+    struct Stats {
+        size_type   m_get_cnt;          // get的次数
+        size_type   m_memory_hit_cnt;   // 内存层命中的次数，包括待写队列
+        size_type   m_tier_hit_cnt;     // 文件层命中的次数
+    };
+
+private:
+    cache_type                                      m_cache;
+    tier_type                                       m_tier;
+
+    /// 正在从待写队列或文件层提升的key，push时递增m_generation使进行中的提升失效
+    struct promotion {
+        size_type   m_readers;
+        uint64_t    m_generation;
+    };
+
+    // 已被内存层淘汰、尚未写入文件层的元素，加锁顺序为 LRU_cache -> 待写队列
+    std::mutex                                      m_pending_mutex;
+    std::unordered_map<key_type, value_ptr_type>    m_pending;
+    std::unordered_map<key_type, promotion>         m_promoting;
+
+    // 串行化文件写入，保证同一key按淘汰顺序写入
+    std::mutex                                      m_drain_mutex;
+    std::atomic<bool>                               m_drain_requested;  // 待写队列中有新的元素
+
+    std::atomic<size_type>                          m_get_cnt;
+    std::atomic<size_type>                          m_memory_hit_cnt;
+    std::atomic<size_type>                          m_tier_hit_cnt;
+
+public:
+    two_tier_cache() = delete;
+    two_tier_cache(const two_tier_cache&) = delete;
+    two_tier_cache& operator=(const two_tier_cache&) = delete;
+
+    ///
+    /// construct
+    /// \param [Size] 内存层最大元素个数，[MemorySize] 内存层最大内存大小（以字节为单位，为0时不限制），
+    ///        [Directory] 文件层目录，[options] 文件层参数
+    ///
+    two_tier_cache(size_type Size, size_type MemorySize,
+                   const std::string& Directory, const typename tier_type::Options& options) :
+        m_cache(Size, MemorySize),
+        m_tier(Directory, options),
+        m_drain_requested(false),
+        m_get_cnt(0),
+        m_memory_hit_cnt(0),
+        m_tier_hit_cnt(0)
+    {
+        m_cache.set_discard_callback([this](const key_type& key, const value_ptr_type& value) {
+            std::lock_guard<std::mutex> lck (m_pending_mutex);
+            m_pending[key] = value;
+            m_drain_requested.store(true, std::memory_order_release);
+        });
+    }
+
+public:
+    ///
+    /// push
+    /// \brief 将k-v对压入内存层，文件层中的旧值一并删除
+    ///
+    void push(const key_type& key, const value_ptr_type& value)
+    {
+        _push(key, value);
+        _drain();
+    }
+
+    ///
+    /// get
+    /// \brief 依次查找内存层、待写队列、文件层，在待写队列或文件层命中时提升回内存层
+    /// \return bool [ture]: 有此k-v对 [false]: 无此k-v对
+    ///
+    bool get(const key_type& key, value_ptr_type& value);
+
+    ///
+    /// start_compaction
+    /// \brief 启动文件层的后台压缩线程，见file_victim_tier::start
+    ///
+    void start_compaction(std::chrono::milliseconds interval)
+    {
+        m_tier.start(interval);
+    }
+
+    void stop_compaction()
+    {
+        m_tier.stop();
+    }
+
+    Stats get_stats() const
+    {
+        Stats stats;
+        stats.m_get_cnt = m_get_cnt.load(std::memory_order_relaxed);
+        stats.m_memory_hit_cnt = m_memory_hit_cnt.load(std::memory_order_relaxed);
+        stats.m_tier_hit_cnt = m_tier_hit_cnt.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const cache_type& memory_tier() const
+    {
+        return m_cache;
+    }
+
+    tier_type& file_tier()
+    {
+        return m_tier;
+    }
+
+private:
+    void _push(const key_type& key, const value_ptr_type& value)
+    {
+        {
+            std::lock_guard<std::mutex> lck (m_pending_mutex);
+            m_pending.erase(key);
+            auto ite = m_promoting.find(key);
+            if (ite != m_promoting.end()) {
+                ++ite->second.m_generation;
+            }
+        }
+        m_tier.erase(key);
+        m_cache.push(key, value);
+    }
+
+    ///
+    /// [内部方法] 将从待写队列或文件层读到的值提升回内存层
+    /// \param [generation] 读取前记录的m_promoting[key].m_generation
+    ///
+    void _promote(const key_type& key, const value_ptr_type& value, uint64_t generation);
+
+    ///
+    /// [内部方法] 将待写队列中的元素写入文件层，写入完成后才从队列中删除
+    /// \details 没有新的待写元素时不加锁直接返回；其他线程正在写入时不等待，由该线程一并写入
+    ///
+    void _drain();
+
+    ///
+    /// [内部方法] 写入当前待写队列中的全部元素，调用方需持有m_drain_mutex
+    ///
+    void _drain_pending();
+
+    /// get期间在m_promoting中登记key，离开作用域时（包括未命中）注销
+    class promotion_guard
+    {
+        two_tier_cache*     m_owner;
+        const key_type&     m_key;
+
+    public:
+        promotion_guard(two_tier_cache* owner, const key_type& key) : m_owner(owner), m_key(key) {}
+        promotion_guard(const promotion_guard&) = delete;
+        promotion_guard& operator=(const promotion_guard&) = delete;
+
+        ~promotion_guard()
+        {
+            std::lock_guard<std::mutex> lck (m_owner->m_pending_mutex);
+            auto ite = m_owner->m_promoting.find(m_key);
+            if (--ite->second.m_readers == 0) {
+                m_owner->m_promoting.erase(ite);
+            }
+        }
+    };
+};
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+bool two_tier_cache<Key, Value, ValueCodec, KeyCodec>::get(const key_type& key, value_ptr_type& value)
+{
+    m_get_cnt.fetch_add(1, std::memory_order_relaxed);
+    if (m_cache.get(key, value)) {
+        m_memory_hit_cnt.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 读取前登记，读取期间对此key的push会使本次提升失效
+    bool pending_hit = false;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lck (m_pending_mutex);
+        auto ite = m_pending.find(key);
+        if (ite != m_pending.end()) {
+            value = ite->second;
+            pending_hit = true;
+        }
+        promotion& p = m_promoting[key];
+        ++p.m_readers;
+        generation = p.m_generation;
+    }
+
+    bool found = true;
+    {
+        promotion_guard guard(this, key);
+        if (pending_hit) {
+            m_memory_hit_cnt.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            value_ptr_type from_tier = std::make_shared<value_type>();
+            if (m_tier.take(key, *from_tier)) {
+                m_tier_hit_cnt.fetch_add(1, std::memory_order_relaxed);
+                value = from_tier;
+            } else {
+                found = false;
+            }
+        }
+
+        if (found) {
+            _promote(key, value, generation);
+        }
+    }
+
+    if (found) {
+        _drain();
+    }
+    return found;
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void two_tier_cache<Key, Value, ValueCodec, KeyCodec>::_promote(const key_type& key, const value_ptr_type& value,
+                                                                 uint64_t generation)
+{
+    // 在LRU_cache的锁内检查，检查与插入之间不会有push插入新值
+    m_cache.push_if_absent(key, value, [this, &key, &value, generation]() {
+        std::lock_guard<std::mutex> lck (m_pending_mutex);
+        if (m_promoting[key].m_generation != generation) {
+            return false;
+        }
+        // 从待写队列提升时，队列中的同一个值不再需要写入文件层
+        auto ite = m_pending.find(key);
+        if (ite != m_pending.end() && ite->second == value) {
+            m_pending.erase(ite);
+        }
+        return true;
+    });
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void two_tier_cache<Key, Value, ValueCodec, KeyCodec>::_drain()
+{
+    // 持有锁的线程在释放前反复检查m_drain_requested，释放后再检查一次，
+    // 因此获取锁失败的线程放入的元素不会遗留在待写队列中
+    while (m_drain_requested.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> drain_lck (m_drain_mutex, std::try_to_lock);
+        if (!drain_lck.owns_lock()) {
+            return;
+        }
+        while (m_drain_requested.exchange(false, std::memory_order_acq_rel)) {
+            _drain_pending();
+        }
+    }
+}
+
+template <typename Key, typename Value, typename ValueCodec, typename KeyCodec>
+void two_tier_cache<Key, Value, ValueCodec, KeyCodec>::_drain_pending()
+{
+    std::vector<std::pair<key_type, value_ptr_type>> batch;
+    {
+        std::lock_guard<std::mutex> lck (m_pending_mutex);
+        if (m_pending.empty()) {
+            return;
+        }
+        batch.assign(m_pending.begin(), m_pending.end());
+    }
+
+    for (auto& item : batch) {
+        m_tier.put(item.first, *item.second);
+    }
+
+    // 写入期间被重新压入或再次淘汰的key以新的状态为准
+    std::lock_guard<std::mutex> lck (m_pending_mutex);
+    for (auto& item : batch) {
+        auto ite = m_pending.find(item.first);
+        if (ite != m_pending.end() && ite->second == item.second) {
+            m_pending.erase(ite);
+        }
+    }
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
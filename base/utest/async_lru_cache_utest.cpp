@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../async_lru_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+uint64_t get_nanosecond() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCacheGetAndPut) {
+    async_lru_cache<int, int> cache(100);
+
+    std::future<void> put_done;
+    ASSERT_TRUE(cache.async_put(1, std::make_shared<int>(10), put_done));
+    put_done.get();
+
+    std::future<std::shared_ptr<int>> result;
+    ASSERT_TRUE(cache.async_get(1, result));
+    auto value = result.get();
+    ASSERT_TRUE(value != nullptr);
+    ASSERT_EQ(10, *value);
+
+    ASSERT_TRUE(cache.async_get(2, result));
+    ASSERT_TRUE(result.get() == nullptr);
+
+    // 回调方式，同一线程提交的命令按顺序执行
+    std::promise<int> found;
+    ASSERT_TRUE(cache.async_put(2, std::make_shared<int>(20)));
+    ASSERT_TRUE(cache.async_get(2, [&found](bool hit, const std::shared_ptr<int>& v) {
+        found.set_value(hit ? *v : -1);
+    }));
+    ASSERT_EQ(20, found.get_future().get());
+
+    bool busy = true;
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, cache.try_get(2, tmp, busy));
+    ASSERT_FALSE(busy);
+    ASSERT_EQ(20, *tmp);
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCacheNonBlocking) {
+    async_lru_cache<int, int, 8> cache(1);
+
+    // 淘汰回调长时间占用容器的锁
+    std::atomic<bool> in_callback(false);
+    std::atomic<bool> release(false);
+    cache.cache().set_discard_callback([&](const int&, const std::shared_ptr<int>&) {
+        in_callback = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    ASSERT_TRUE(cache.async_put(1, std::make_shared<int>(1)));
+    ASSERT_TRUE(cache.async_put(2, std::make_shared<int>(2)));
+    while (!in_callback) {
+        std::this_thread::yield();
+    }
+
+    // 提交与try_get都不等待，队列满时提交失败
+    std::atomic<int> completed(0);
+    int submitted = 0;
+    uint64_t begin = get_nanosecond();
+    for (int i = 0; i < 100; ++i) {
+        if (cache.async_get(2, [&completed](bool, const std::shared_ptr<int>&) { ++completed; })) {
+            ++submitted;
+        }
+    }
+    bool busy = false;
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(0, cache.try_get(2, tmp, busy));
+    ASSERT_TRUE(busy);
+    uint64_t elapsed = get_nanosecond() - begin;
+
+    EXPECT_EQ(8, submitted);
+    EXPECT_GT(100000000U, elapsed);
+
+    std::future<std::shared_ptr<int>> result;
+    ASSERT_FALSE(cache.async_get(2, result));
+    ASSERT_FALSE(result.valid());
+
+    release = true;
+    cache.close();
+    EXPECT_EQ(submitted, completed.load());
+    ASSERT_FALSE(cache.async_put(3, std::make_shared<int>(3)));
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCacheClose) {
+    std::atomic<int> completed(0);
+    {
+        async_lru_cache<int, int> cache(1000);
+        for (int i = 0; i < 1000; ++i) {
+            while (!cache.async_put(i, std::make_shared<int>(i), [&completed]() { ++completed; })) {
+                std::this_thread::yield();
+            }
+        }
+        // 析构时执行完所有已提交的命令
+    }
+    EXPECT_EQ(1000, completed.load());
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCacheCloseRace) {
+    // 与close并发提交，返回true的命令都已执行
+    for (int round = 0; round < 50; ++round) {
+        std::atomic<int> accepted(0);
+        std::atomic<int> completed(0);
+        async_lru_cache<int, int> cache(100);
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < 2; ++t) {
+            submitters.emplace_back([&cache, &accepted, &completed, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    if (cache.async_put(i * 2 + t, std::make_shared<int>(i), [&completed]() { ++completed; })) {
+                        ++accepted;
+                    }
+                }
+            });
+        }
+        std::this_thread::yield();
+        cache.close();
+        for (auto& s : submitters) {
+            s.join();
+        }
+        ASSERT_EQ(accepted.load(), completed.load());
+    }
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCachePerformance) {
+    const int threads = 4;
+    const int n = 200000;
+    const int keys = 10000;
+
+    // 多线程直接调用
+    LRU_cache<int, int> direct(keys);
+    for (int i = 0; i < keys; ++i) {
+        direct.push(i, std::make_shared<int>(i));
+    }
+    uint64_t begin = get_nanosecond();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&direct, t]() {
+            auto tmp = std::make_shared<int>(-1);
+            for (int i = 0; i < n; ++i) {
+                direct.get((i * 7 + t) % keys, tmp);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    uint64_t direct_ns = get_nanosecond() - begin;
+
+    // 多线程通过异步前端提交
+    async_lru_cache<int, int> async(keys);
+    for (int i = 0; i < keys; ++i) {
+        async.cache().push(i, std::make_shared<int>(i));
+    }
+    std::atomic<int> completed(0);
+    workers.clear();
+    begin = get_nanosecond();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&async, &completed, t]() {
+            auto on_get = [&completed](bool, const std::shared_ptr<int>&) {
+                completed.fetch_add(1, std::memory_order_relaxed);
+            };
+            for (int i = 0; i < n; ++i) {
+                while (!async.async_get((i * 7 + t) % keys, on_get)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    while (completed.load() < threads * n) {
+        std::this_thread::yield();
+    }
+    uint64_t async_ns = get_nanosecond() - begin;
+
+    std::cout << "direct get: " << 1.0 * direct_ns / (threads * n) << " ns/op, "
+              << "async get: " << 1.0 * async_ns / (threads * n) << " ns/op" << std::endl;
+    EXPECT_EQ(static_cast<size_t >(threads * n), async.cache().get_stats().m_get_cnt);
+}
+
+TEST(AsyncLRUCacheTest, AsyncLRUCacheContendedPerformance) {
+    const int readers = 2;
+    const int n = 500;
+    const int keys = 1000;
+
+    // 写线程持续压入新key，淘汰回调在锁内停留约100us，比较调用线程在get上被阻塞的时间；
+    // 读线程每次get之间稍作停顿，让写线程有机会持有锁
+    auto run = [&](LRU_cache<int, int>& lru, std::function<bool(int)> get) {
+        for (int i = 0; i < keys; ++i) {
+            lru.push(i, std::make_shared<int>(i));
+        }
+        std::atomic<bool> evicting(false);
+        lru.set_discard_callback([&evicting](const int&, const std::shared_ptr<int>&) {
+            evicting = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        });
+
+        std::atomic<bool> done(false);
+        std::thread writer([&lru, &done, keys]() {
+            for (int i = keys; !done; ++i) {
+                lru.push(i, std::make_shared<int>(i));
+                std::this_thread::yield();
+            }
+        });
+        std::vector<uint64_t> blocked(readers, 0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < readers; ++t) {
+            workers.emplace_back([&get, &blocked, &evicting, keys, t]() {
+                while (!evicting) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < n; ++i) {
+                    uint64_t begin = get_nanosecond();
+                    get((i * 7 + t) % keys);
+                    blocked[t] += get_nanosecond() - begin;
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        done = true;
+        writer.join();
+        lru.set_discard_callback(nullptr);
+
+        uint64_t sum = 0;
+        for (auto x : blocked) {
+            sum += x;
+        }
+        return 1.0 * sum / (readers * n);
+    };
+
+    LRU_cache<int, int> direct(keys);
+    double direct_ns = run(direct, [&direct](int key) {
+        auto tmp = std::make_shared<int>(-1);
+        return direct.get(key, tmp);
+    });
+
+    async_lru_cache<int, int> async(keys);
+    std::atomic<int> rejected(0);
+    double async_ns = run(async.cache(), [&async, &rejected](int key) {
+        bool ok = async.async_get(key, [](bool, const std::shared_ptr<int>&) {});
+        rejected += !ok;
+        return ok;
+    });
+    async.close();
+
+    std::cout << "with a slow discard callback, direct get blocks " << direct_ns << " ns/op, "
+              << "async get blocks " << async_ns << " ns/op, "
+              << "async rejected " << rejected.load() << "/" << readers * n << std::endl;
+    // 直接调用需等待回调释放锁，异步提交不获取容器的锁
+    EXPECT_LT(async_ns, direct_ns);
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
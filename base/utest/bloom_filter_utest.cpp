@@ -0,0 +1,139 @@
+#include <assert.h>
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <sys/time.h>
+#include <thread>
+#include <vector>
+
+#include "../bloom_filter.h"
+
+namespace tinycommon {
+namespace base {
+
+TEST(BloomFilterTest, CBFAddAndRemove) {
+    int n = 1000;
+    counting_bloom_filter<int> cbf(static_cast<size_t>(n));
+
+    for (int i = 0; i < n; ++i) {
+        cbf.add(i);
+    }
+
+    // 不会漏判
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(true, cbf.may_contain(i));
+    }
+
+    // 重复添加后需删除相同次数
+    cbf.add(0);
+    cbf.remove(0);
+    ASSERT_EQ(true, cbf.may_contain(0));
+
+    for (int i = 0; i < n; ++i) {
+        cbf.remove(i);
+    }
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(false, cbf.may_contain(i));
+    }
+
+    // 复制构造函数
+    cbf.add(n);
+    counting_bloom_filter<int> cbf1(cbf);
+    ASSERT_EQ(true, cbf1.may_contain(n));
+    cbf.clear();
+    ASSERT_EQ(false, cbf.may_contain(n));
+    ASSERT_EQ(true, cbf1.may_contain(n));
+}
+
+TEST(BloomFilterTest, CBFFalsePositiveRate) {
+    int n = 100000;
+    counting_bloom_filter<int> cbf(static_cast<size_t>(n), 0.01);
+    for (int i = 0; i < n; ++i) {
+        cbf.add(i);
+    }
+
+    int fp = 0;
+    for (int i = n; i < n * 2; ++i) {
+        if (cbf.may_contain(i)) {
+            ++fp;
+        }
+    }
+
+    double rate = 1.0 * fp / n;
+    std::cout << "counting bloom filter false positive rate:" << rate << std::endl;
+    EXPECT_LT(rate, 0.02);
+
+    // 字符串key
+    counting_bloom_filter<std::string> cbf_str(100);
+    cbf_str.add("hello");
+    EXPECT_EQ(true, cbf_str.may_contain("hello"));
+}
+
+TEST(BloomFilterTest, CBFConcurrent) {
+    const int n = 10000;
+    const int threads = 4;
+    counting_bloom_filter<int> cbf(static_cast<size_t>(n * threads));
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&cbf, t]() {
+            for (int i = t * n; i < (t + 1) * n; ++i) {
+                cbf.add(i);
+            }
+        }));
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (int i = 0; i < n * threads; ++i) {
+        ASSERT_EQ(true, cbf.may_contain(i));
+    }
+}
+
+TEST(BloomFilterTest, RBFRotate) {
+    int n = 1000;
+    rotating_bloom_filter<int> rbf(static_cast<size_t>(n));
+
+    for (int i = 0; i < n - 1; ++i) {
+        rbf.insert(i);
+    }
+    ASSERT_EQ(0U, rbf.rotations());
+    for (int i = 0; i < n - 1; ++i) {
+        ASSERT_EQ(true, rbf.may_contain(i));
+    }
+
+    // current写满后自动轮换，旧的一代仍然可查
+    rbf.insert(n - 1);
+    ASSERT_EQ(1U, rbf.rotations());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(true, rbf.may_contain(i));
+    }
+
+    // 再轮换一次后，第一代老化
+    rbf.rotate();
+    ASSERT_EQ(2U, rbf.rotations());
+    int remain = 0;
+    for (int i = 0; i < n; ++i) {
+        if (rbf.may_contain(i)) {
+            ++remain;
+        }
+    }
+    EXPECT_EQ(0, remain);
+
+    rbf.insert(n);
+    ASSERT_EQ(true, rbf.may_contain(n));
+    rbf.clear();
+    ASSERT_EQ(false, rbf.may_contain(n));
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,260 @@
+#include <assert.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+#include <sys/time.h>
+#include <thread>
+#include <vector>
+
+#include "../broadcast_ring.h"
+
+namespace tinycommon {
+namespace base {
+
+uint64_t get_nanosecond() {
+    timespec time_now;
+    clock_gettime(CLOCK_MONOTONIC, &time_now);
+    return static_cast<uint64_t>(time_now.tv_sec) * 1000000000ULL +
+        static_cast<uint64_t>(time_now.tv_nsec);
+}
+
+TEST(BroadcastRingTest, BRConstruct) {
+    broadcast_ring<int, 8> br(3);
+    ASSERT_EQ(8U, br.capacity());
+    ASSERT_EQ(3U, br.consumers());
+    for (size_t i = 0; i < br.consumers(); ++i) {
+        ASSERT_EQ(0U, br.size(i));
+        int tmp = -1;
+        ASSERT_EQ(false, br.pop(i, tmp));
+    }
+}
+
+TEST(BroadcastRingTest, BRBroadcast) {
+    const int n = 8;
+    broadcast_ring<int, n> br(2);
+
+    // 每个对象只写入一次，所有消费者都能读到
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(true, br.try_push_back(i));
+    }
+    ASSERT_EQ(static_cast<size_t>(n), br.size(0));
+    ASSERT_EQ(static_cast<size_t>(n), br.size(1));
+
+    // 最慢的消费者未读取时，队列已满
+    ASSERT_EQ(false, br.try_push_back(n));
+
+    for (int i = 0; i < n; ++i) {
+        int tmp = -1;
+        ASSERT_EQ(true, br.pop(0, tmp));
+        ASSERT_EQ(i, tmp);
+    }
+    ASSERT_EQ(0U, br.size(0));
+    ASSERT_EQ(false, br.try_push_back(n));
+
+    // 批量读取
+    std::vector<int> got;
+    ASSERT_EQ(3U, br.consume(1, [&got](const int& v) { got.push_back(v); }, 3));
+    ASSERT_EQ(3U, got.size());
+    ASSERT_EQ(true, br.try_push_back(n));
+    ASSERT_EQ(static_cast<size_t>(n - 3 + 1), br.consume(1, [&got](const int& v) { got.push_back(v); }));
+    for (int i = 0; i <= n; ++i) {
+        ASSERT_EQ(i, got[i]);
+    }
+
+    int tmp = -1;
+    ASSERT_EQ(true, br.pop(0, tmp));
+    ASSERT_EQ(n, tmp);
+}
+
+TEST(BroadcastRingTest, BROverwrite) {
+    const int n = 4;
+    broadcast_ring<int, n, true> br(2);
+
+    // 覆盖模式下不等待，落后的消费者跳过被覆盖的对象
+    for (int i = 0; i < n * 3; ++i) {
+        ASSERT_EQ(true, br.try_push_back(i));
+        int tmp = -1;
+        ASSERT_EQ(true, br.pop(0, tmp));
+        ASSERT_EQ(i, tmp);
+    }
+    ASSERT_EQ(0U, br.overrun(0));
+    ASSERT_EQ(static_cast<size_t>(n), br.size(1));
+
+    std::vector<int> got;
+    br.consume(1, [&got](const int& v) { got.push_back(v); });
+    ASSERT_EQ(static_cast<size_t>(n), got.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(n * 2 + i, got[i]);
+    }
+    ASSERT_EQ(static_cast<uint64_t>(n * 2), br.overrun(1));
+}
+
+TEST(BroadcastRingTest, BRConcurrent) {
+    const int consumers = 4;
+    const uint64_t n = 200000;
+    broadcast_ring<uint64_t, 1024> br(consumers);
+
+    std::vector<uint64_t> sums(consumers, 0);
+    std::vector<int> ordered(consumers, 1);
+    std::vector<std::thread> workers;
+    for (int c = 0; c < consumers; ++c) {
+        workers.push_back(std::thread([&br, &sums, &ordered, c, n]() {
+            uint64_t expect = 0;
+            while (expect < n) {
+                size_t got = br.consume(c, [&](const uint64_t& v) {
+                    if (v != expect) {
+                        ordered[c] = 0;
+                    }
+                    sums[c] += v;
+                    ++expect;
+                });
+                if (got == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    for (uint64_t i = 0; i < n; ++i) {
+        br.push_back(i);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (int c = 0; c < consumers; ++c) {
+        EXPECT_EQ(1, ordered[c]);
+        EXPECT_EQ(n * (n - 1) / 2, sums[c]);
+    }
+}
+
+TEST(BroadcastRingTest, BROverwriteConcurrent) {
+    const uint64_t n = 200000;
+    broadcast_ring<uint64_t, 64, true> br(1);
+
+    std::atomic<bool> done(false);
+    int monotonic = 1;
+    uint64_t received = 0;
+    std::thread consumer([&]() {
+        uint64_t last = 0;
+        bool first = true;
+        while (true) {
+            bool finished = done.load();
+            size_t got = br.consume(0, [&](const uint64_t& v) {
+                if (!first && v <= last) {
+                    monotonic = 0;
+                }
+                first = false;
+                last = v;
+                ++received;
+            });
+            if (got == 0) {
+                if (finished) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint64_t i = 0; i < n; ++i) {
+        br.push_back(i);
+    }
+    done.store(true);
+    consumer.join();
+
+    // 读到的对象严格递增，且读到的与跳过的之和等于写入总数
+    EXPECT_EQ(1, monotonic);
+    EXPECT_EQ(n, received + br.overrun(0));
+}
+
+/// 跨多个字的对象，用于检查覆盖模式下不会读到被撕裂的对象
+struct triple {
+    uint64_t    m_a;
+    uint64_t    m_b;
+    uint32_t    m_c;
+};
+
+TEST(BroadcastRingTest, BROverwriteTorn) {
+    const uint64_t n = 200000;
+    broadcast_ring<triple, 16, true> br(1);
+
+    std::atomic<bool> done(false);
+    int torn = 0;
+    uint64_t received = 0;
+    std::thread consumer([&]() {
+        while (true) {
+            bool finished = done.load();
+            size_t got = br.consume(0, [&](const triple& v) {
+                if (v.m_a != v.m_b || static_cast<uint32_t>(v.m_a) != v.m_c) {
+                    ++torn;
+                }
+                ++received;
+            });
+            if (got == 0) {
+                if (finished) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint64_t i = 0; i < n; ++i) {
+        br.push_back(triple{i, i, static_cast<uint32_t>(i)});
+    }
+    done.store(true);
+    consumer.join();
+
+    EXPECT_EQ(0, torn);
+    EXPECT_EQ(n, received + br.overrun(0));
+}
+
+template <int Consumers>
+double bench_broadcast(uint64_t n) {
+    broadcast_ring<uint64_t, 4096> br(Consumers);
+
+    std::vector<std::thread> workers;
+    for (int c = 0; c < Consumers; ++c) {
+        workers.push_back(std::thread([&br, c, n]() {
+            uint64_t read = 0;
+            while (read < n) {
+                size_t got = br.consume(c, [](const uint64_t&) {});
+                read += got;
+                if (got == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    uint64_t begin = get_nanosecond();
+    for (uint64_t i = 0; i < n; ++i) {
+        br.push_back(i);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    uint64_t end = get_nanosecond();
+    return 1.0 * n / (end - begin) * 1000;
+}
+
+TEST(BroadcastRingTest, BRPerformance) {
+    const uint64_t n = 2000000;
+
+    std::cout << "throughput with 1 consumer:"
+              << bench_broadcast<1>(n) << " M/s" << std::endl;
+    std::cout << "throughput with 8 consumers:"
+              << bench_broadcast<8>(n) << " M/s" << std::endl;
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -1,9 +1,16 @@
 #include <assert.h>
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
 #include <iostream>
 #include <stdio.h>
 #include <sys/time.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #include "../circular_queue.h"
 
 namespace tinycommon {
@@ -190,6 +197,113 @@ TEST(CircularQueueTest, CQPerformance) {
 
 }
 
+TEST(CircularQueueTest, CQSizeRelaxed) {
+    circular_queue<int, 3> cq;
+    ASSERT_EQ(0U, cq.size_relaxed());
+
+    for (int i = 1; i <= 5; ++i) {
+        cq.push_back(i);
+        ASSERT_EQ(cq.size(), cq.size_relaxed());
+    }
+    ASSERT_EQ(3U, cq.size_relaxed());
+
+    circular_queue<int, 3> cq1(cq);
+    ASSERT_EQ(3U, cq1.size_relaxed());
+
+    for (int i = 2; i >= 0; --i) {
+        cq.pop();
+        ASSERT_EQ(static_cast<size_t>(i), cq.size_relaxed());
+    }
+    ASSERT_EQ(true, cq.empty());
+
+    cq1 = cq;
+    ASSERT_EQ(0U, cq1.size_relaxed());
+}
+
+/// 将当前线程绑定到第cpu个CPU上，CPU个数不足时不绑定
+void pin_to_cpu(unsigned cpu) {
+    if (std::thread::hardware_concurrency() <= cpu) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+struct polling_result {
+    uint64_t    m_push_ns;  // 写线程每次push_back的平均耗时
+    uint64_t    m_polls;    // 轮询线程的总轮询次数
+    uint64_t    m_poll_ns;  // 每次轮询的平均耗时
+};
+
+/// 写线程push_back的同时，pollers个线程各自每隔约1us调用一次poll；
+/// 轮询频率固定，各线程分别绑定到不同的CPU（CPU足够时），写线程的耗时只反映轮询带来的锁与cache line竞争
+template <typename Poll>
+polling_result bench_push_with_pollers(int pollers, Poll poll) {
+    const int n = 200000;
+    circular_queue<int, 1024> cq;
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> sink(0);
+    std::atomic<uint64_t> polls(0);
+    std::atomic<uint64_t> poll_ns(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < pollers; ++i) {
+        threads.emplace_back([&, i]() {
+            pin_to_cpu(static_cast<unsigned>(i + 1));
+            size_t sum = 0;
+            uint64_t count = 0;
+            std::chrono::steady_clock::duration busy(0);
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto begin = std::chrono::steady_clock::now();
+                sum += poll(cq);
+                busy += std::chrono::steady_clock::now() - begin;
+                ++count;
+                std::this_thread::sleep_for(std::chrono::microseconds(1));
+            }
+            sink += sum;
+            polls += count;
+            poll_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count());
+        });
+    }
+
+    uint64_t elapsed = 0;
+    std::thread writer([&]() {
+        pin_to_cpu(0);
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            cq.push_back(i);
+        }
+        auto end = std::chrono::steady_clock::now();
+        elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    });
+    writer.join();
+
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    return polling_result{elapsed / n, polls.load(), polls.load() == 0 ? 0 : poll_ns.load() / polls.load()};
+}
+
+TEST(CircularQueueTest, CQPollingPerformance) {
+    typedef circular_queue<int, 1024> queue_type;
+    polling_result idle = bench_push_with_pollers(0, [](const queue_type& cq) { return cq.size(); });
+    polling_result locked = bench_push_with_pollers(3, [](const queue_type& cq) { return cq.size(); });
+    polling_result relaxed = bench_push_with_pollers(3, [](const queue_type& cq) { return cq.size_relaxed(); });
+
+    std::cout << "push latency, no pollers: " << idle.m_push_ns << " ns"
+              << ", polling size(): " << locked.m_push_ns << " ns"
+              << ", polling size_relaxed(): " << relaxed.m_push_ns << " ns"
+              << ", locked - relaxed: " << static_cast<int64_t>(locked.m_push_ns - relaxed.m_push_ns) << " ns"
+              << std::endl;
+    std::cout << "poll latency, size(): " << locked.m_poll_ns << " ns (" << locked.m_polls << " polls)"
+              << ", size_relaxed(): " << relaxed.m_poll_ns << " ns (" << relaxed.m_polls << " polls)"
+              << std::endl;
+    // 无锁读取不会等待写线程释放锁
+    EXPECT_LT(relaxed.m_poll_ns, locked.m_poll_ns);
+}
+
 }// namespace common
 }// namespace mapauto
 
@@ -0,0 +1,296 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "../file_victim_tier.h"
+
+namespace tinycommon {
+namespace base {
+
+/// 在/tmp下创建临时目录，析构时删除
+class temp_dir
+{
+public:
+    std::string m_path;
+
+    temp_dir()
+    {
+        char buf[] = "/tmp/victim_tier_XXXXXX";
+        m_path = mkdtemp(buf);
+    }
+
+    ~temp_dir()
+    {
+        rmdir(m_path.c_str());
+    }
+};
+
+using int_tier = file_victim_tier<int, int>;
+
+TEST(FileVictimTierTest, FileVictimTierPutAndGet) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {4096, 0, 0.5});
+
+    int n = 1000;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.put(i, i * 2));
+    }
+    ASSERT_EQ(static_cast<size_t >(n), tier.size());
+    ASSERT_LT(1U, tier.get_segment_count());
+
+    int tmp = -1;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.get(i, tmp));
+        ASSERT_EQ(i * 2, tmp);
+    }
+    ASSERT_FALSE(tier.get(n, tmp));
+
+    // 覆盖旧值
+    ASSERT_TRUE(tier.put(0, -100));
+    ASSERT_TRUE(tier.get(0, tmp));
+    ASSERT_EQ(-100, tmp);
+    ASSERT_EQ(static_cast<size_t >(n), tier.size());
+
+    // take后删除
+    ASSERT_TRUE(tier.take(1, tmp));
+    ASSERT_EQ(2, tmp);
+    ASSERT_FALSE(tier.exists(1));
+    ASSERT_FALSE(tier.get(1, tmp));
+
+    tier.erase(2);
+    ASSERT_FALSE(tier.exists(2));
+    ASSERT_EQ(static_cast<size_t >(n - 2), tier.size());
+
+    auto stats = tier.get_stats();
+    EXPECT_EQ(static_cast<size_t >(n + 4), stats.m_get_cnt);
+    EXPECT_EQ(static_cast<size_t >(n + 2), stats.m_hit_cnt);
+}
+
+TEST(FileVictimTierTest, FileVictimTierString) {
+    temp_dir dir;
+    file_victim_tier<int, std::string, string_codec> tier(dir.m_path, {1 << 20, 0, 0.5});
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(tier.put(i, std::string(static_cast<size_t >(i), 'a' + i % 26)));
+    }
+
+    std::string tmp;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(tier.get(i, tmp));
+        ASSERT_EQ(std::string(static_cast<size_t >(i), 'a' + i % 26), tmp);
+    }
+}
+
+TEST(FileVictimTierTest, FileVictimTierCompact) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 0, 0.5});
+
+    int n = 1000;
+    for (int i = 0; i < n; ++i) {
+        tier.put(i, i);
+    }
+    // 删除大部分key，旧分段的有效数据比例降低
+    for (int i = 0; i < n; ++i) {
+        if (i % 4 != 0) {
+            tier.erase(i);
+        }
+    }
+    size_t before = tier.get_disk_size();
+
+    while (tier.compact()) {
+    }
+    EXPECT_LT(tier.get_disk_size(), before / 2);
+    EXPECT_LT(0U, tier.get_stats().m_compact_cnt);
+
+    int tmp = -1;
+    for (int i = 0; i < n; ++i) {
+        if (i % 4 == 0) {
+            ASSERT_TRUE(tier.get(i, tmp));
+            ASSERT_EQ(i, tmp);
+        } else {
+            ASSERT_FALSE(tier.exists(i));
+        }
+    }
+}
+
+TEST(FileVictimTierTest, FileVictimTierSegmentSize) {
+    // 分段大小过小时取下限，大于分段大小的记录不会各自占用一个分段
+    temp_dir dir;
+    file_victim_tier<int, std::string, string_codec> tier(dir.m_path, {64, 0, 0.5});
+    int n = 100;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.put(i, std::string(100, 'a')));
+    }
+    // 每条记录112字节，每个分段9条
+    EXPECT_EQ(12U, tier.get_segment_count());
+
+    // 零初始化的参数
+    temp_dir dir2;
+    file_victim_tier<int, std::string, string_codec> tier2(dir2.m_path, {0, 0, 0.5});
+    ASSERT_TRUE(tier2.put(0, std::string(4096, 'b')));
+    ASSERT_TRUE(tier2.put(1, std::string(10, 'c')));
+    ASSERT_TRUE(tier2.put(2, std::string(10, 'd')));
+    EXPECT_EQ(2U, tier2.get_segment_count());
+
+    std::string tmp;
+    ASSERT_TRUE(tier2.get(0, tmp));
+    ASSERT_EQ(std::string(4096, 'b'), tmp);
+}
+
+TEST(FileVictimTierTest, FileVictimTierCompactAbort) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 0, 0.5});
+
+    // 每条记录16字节，分段0恰好写满64条
+    for (int i = 0; i < 65; ++i) {
+        ASSERT_TRUE(tier.put(i, i));
+    }
+    ASSERT_EQ(2U, tier.get_segment_count());
+    for (int i = 0; i < 60; ++i) {
+        tier.erase(i);
+    }
+
+    // 分段0中key为61的记录头被破坏
+    std::string path = dir.m_path + "/victim_0.seg";
+    int fd = open(path.c_str(), O_WRONLY);
+    ASSERT_LE(0, fd);
+    uint32_t bad_key_len = 3;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(bad_key_len)), pwrite(fd, &bad_key_len, sizeof(bad_key_len), 61 * 16));
+    close(fd);
+
+    // 无法解析时放弃压缩，保留分段，其后的有效数据仍可读取，之后不再选中该分段
+    EXPECT_FALSE(tier.compact());
+    EXPECT_EQ(2U, tier.get_segment_count());
+    int tmp = -1;
+    for (int i = 60; i < 65; ++i) {
+        if (i != 61) {
+            ASSERT_TRUE(tier.get(i, tmp));
+            ASSERT_EQ(i, tmp);
+        }
+    }
+    EXPECT_FALSE(tier.compact());
+    EXPECT_EQ(0U, tier.get_stats().m_compact_cnt);
+}
+
+TEST(FileVictimTierTest, FileVictimTierCompactWriteFailure) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 0, 0.5});
+
+    // 分段0与分段1均写满
+    for (int i = 0; i < 128; ++i) {
+        ASSERT_TRUE(tier.put(i, i));
+    }
+    ASSERT_EQ(2U, tier.get_segment_count());
+    for (int i = 0; i < 60; ++i) {
+        tier.erase(i);
+    }
+
+    // 目录不可用时无法创建新分段，重写失败，保留原分段
+    std::string moved = dir.m_path + "_moved";
+    ASSERT_EQ(0, rename(dir.m_path.c_str(), moved.c_str()));
+    EXPECT_FALSE(tier.compact());
+    EXPECT_EQ(2U, tier.get_segment_count());
+    int tmp = -1;
+    for (int i = 60; i < 128; ++i) {
+        ASSERT_TRUE(tier.get(i, tmp));
+        ASSERT_EQ(i, tmp);
+    }
+
+    // 目录恢复后可以正常压缩
+    ASSERT_EQ(0, rename(moved.c_str(), dir.m_path.c_str()));
+    EXPECT_TRUE(tier.compact());
+    for (int i = 60; i < 128; ++i) {
+        ASSERT_TRUE(tier.get(i, tmp));
+        ASSERT_EQ(i, tmp);
+    }
+}
+
+TEST(FileVictimTierTest, FileVictimTierBackgroundCompact) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 0, 0.5});
+    tier.start(std::chrono::milliseconds(1));
+
+    // 反复覆盖同一批key，由后台线程回收失效数据
+    int n = 100;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < n; ++i) {
+            ASSERT_TRUE(tier.put(i, round * n + i));
+        }
+    }
+
+    int tmp = -1;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.get(i, tmp));
+        ASSERT_EQ(99 * n + i, tmp);
+    }
+
+    for (int i = 0; i < 1000 && tier.get_disk_size() > 8192; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    tier.stop();
+    EXPECT_GE(8192U, tier.get_disk_size());
+}
+
+TEST(FileVictimTierTest, FileVictimTierMaxBytes) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 4096, 0.5});
+
+    int n = 10000;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.put(i, i));
+    }
+    ASSERT_GE(4096U, tier.get_disk_size());
+    ASSERT_LT(0U, tier.get_stats().m_drop_cnt);
+
+    // 最旧的数据被丢弃，最新的数据仍在
+    int tmp = -1;
+    ASSERT_FALSE(tier.get(0, tmp));
+    ASSERT_TRUE(tier.get(n - 1, tmp));
+    ASSERT_EQ(n - 1, tmp);
+    ASSERT_GE(4096U / 16, tier.size());
+}
+
+TEST(FileVictimTierTest, FileVictimTierCompactMaxBytes) {
+    temp_dir dir;
+    int_tier tier(dir.m_path, {1024, 3100, 0.6});
+
+    // 3个写满的分段加上1条记录，总大小3088字节，接近上限
+    int n = 64 * 3 + 1;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(tier.put(i, i));
+    }
+    ASSERT_EQ(4U, tier.get_segment_count());
+    for (int i = 0; i < 64; i += 2) {
+        tier.erase(i);
+    }
+
+    // 重写期间总大小暂时超出上限，不能因此删除被压缩的分段或其他分段
+    ASSERT_TRUE(tier.compact());
+    EXPECT_EQ(0U, tier.get_stats().m_drop_cnt);
+    EXPECT_GE(3100U, tier.get_disk_size());
+
+    int tmp = -1;
+    for (int i = 0; i < n; ++i) {
+        if (i < 64 && i % 2 == 0) {
+            ASSERT_FALSE(tier.exists(i));
+        } else {
+            ASSERT_TRUE(tier.get(i, tmp));
+            ASSERT_EQ(i, tmp);
+        }
+    }
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
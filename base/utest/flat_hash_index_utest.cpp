@@ -0,0 +1,209 @@
+#include <assert.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <sys/time.h>
+#include <unordered_map>
+#include <vector>
+
+#include "../flat_hash_index.h"
+
+namespace tinycommon {
+namespace base {
+
+uint64_t get_nanosecond() {
+    timespec time_now;
+    clock_gettime(CLOCK_MONOTONIC, &time_now);
+    return static_cast<uint64_t>(time_now.tv_sec) * 1000000000ULL +
+        static_cast<uint64_t>(time_now.tv_nsec);
+}
+
+TEST(FlatHashIndexTest, FHIInsertAndFind) {
+    int n = 10000;
+    flat_hash_index<int, int> fhi;
+    ASSERT_EQ(0U, fhi.size());
+    ASSERT_EQ(true, fhi.empty());
+    ASSERT_EQ(true, fhi.find(0) == fhi.end());
+
+    for (int i = 0; i < n; ++i) {
+        auto ret = fhi.insert(i, i + n);
+        ASSERT_EQ(true, ret.second);
+        ASSERT_EQ(i, ret.first->first);
+        ASSERT_EQ(static_cast<size_t>(i + 1), fhi.size());
+    }
+
+    // 重复插入不修改
+    auto ret = fhi.insert(0, -1);
+    ASSERT_EQ(false, ret.second);
+    ASSERT_EQ(n, ret.first->second);
+
+    for (int i = 0; i < n; ++i) {
+        auto ite = fhi.find(i);
+        ASSERT_EQ(true, ite != fhi.end());
+        ASSERT_EQ(i + n, ite->second);
+    }
+    for (int i = n; i < n * 2; ++i) {
+        ASSERT_EQ(true, fhi.find(i) == fhi.end());
+    }
+
+    // operator[]
+    fhi[0] = -1;
+    ASSERT_EQ(-1, fhi.find(0)->second);
+    ASSERT_EQ(0, fhi[n * 3]);
+    ASSERT_EQ(static_cast<size_t>(n + 1), fhi.size());
+
+    // 遍历
+    size_t cnt = 0;
+    for (auto ite = fhi.begin(); ite != fhi.end(); ++ite) {
+        ++cnt;
+    }
+    ASSERT_EQ(fhi.size(), cnt);
+
+    // 字符串key
+    flat_hash_index<std::string, int> fhi_str;
+    fhi_str["hello"] = 1;
+    fhi_str["world"] = 2;
+    ASSERT_EQ(1, fhi_str.find("hello")->second);
+    ASSERT_EQ(2, fhi_str.find("world")->second);
+    ASSERT_EQ(1U, fhi_str.erase("hello"));
+    ASSERT_EQ(true, fhi_str.find("hello") == fhi_str.end());
+}
+
+TEST(FlatHashIndexTest, FHIErase) {
+    int n = 10000;
+    flat_hash_index<int, int> fhi;
+    for (int i = 0; i < n; ++i) {
+        fhi.insert(i, i);
+    }
+
+    // 删除偶数，奇数仍可查找（删除时后续元素前移，不能破坏探测序列）
+    for (int i = 0; i < n; i += 2) {
+        ASSERT_EQ(1U, fhi.erase(i));
+        ASSERT_EQ(0U, fhi.erase(i));
+    }
+    ASSERT_EQ(static_cast<size_t>(n / 2), fhi.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i % 2 == 1, fhi.find(i) != fhi.end());
+    }
+
+    // 按迭代器删除
+    fhi.erase(fhi.find(1));
+    ASSERT_EQ(true, fhi.find(1) == fhi.end());
+
+    fhi.clear();
+    ASSERT_EQ(0U, fhi.size());
+    ASSERT_EQ(true, fhi.begin() == fhi.end());
+}
+
+TEST(FlatHashIndexTest, FHIChurn) {
+    // 模拟LRU：滑动窗口内的key持续插入与删除，对照std::unordered_map
+    const int window = 1000;
+    const int total = 200000;
+    flat_hash_index<int, int> fhi;
+    std::unordered_map<int, int> ref;
+
+    for (int i = 0; i < total; ++i) {
+        fhi.insert(i, i);
+        ref[i] = i;
+        if (i >= window) {
+            ASSERT_EQ(1U, fhi.erase(i - window));
+            ref.erase(i - window);
+        }
+        if (i % 997 == 0) {
+            for (int j = i - window * 2; j <= i; ++j) {
+                ASSERT_EQ(ref.count(j) != 0, fhi.find(j) != fhi.end());
+            }
+        }
+    }
+    ASSERT_EQ(ref.size(), fhi.size());
+    // 删除不产生墓碑，容量不会因为反复插入删除而增长
+    EXPECT_GE(2048U, fhi.capacity());
+}
+
+TEST(FlatHashIndexTest, FHICopy) {
+    int n = 1000;
+    flat_hash_index<int, std::string> fhi;
+    for (int i = 0; i < n; ++i) {
+        fhi.insert(i, std::to_string(i));
+    }
+
+    flat_hash_index<int, std::string> fhi1(fhi);
+    flat_hash_index<int, std::string> fhi2;
+    fhi2 = fhi;
+    fhi.clear();
+
+    ASSERT_EQ(static_cast<size_t>(n), fhi1.size());
+    ASSERT_EQ(static_cast<size_t>(n), fhi2.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(std::to_string(i), fhi1.find(i)->second);
+        ASSERT_EQ(std::to_string(i), fhi2.find(i)->second);
+    }
+
+    const flat_hash_index<int, std::string>& cref = fhi1;
+    ASSERT_EQ(true, cref.find(0) != cref.end());
+    ASSERT_EQ(true, cref.find(n) == cref.end());
+}
+
+template <typename Map>
+void bench_lookup(const char* name, size_t cap) {
+    Map map;
+    map.reserve(cap);
+    for (size_t i = 0; i < cap; ++i) {
+        map[static_cast<int64_t>(i)] = static_cast<int64_t>(i);
+    }
+
+    // 随机顺序访问，避免顺序访问的缓存局部性
+    std::vector<int64_t> keys(cap);
+    uint64_t seed = 88172645463325252ULL;
+    for (size_t i = 0; i < cap; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        keys[i] = static_cast<int64_t>(seed % cap);
+    }
+
+    int64_t sum = 0;
+    uint64_t begin = get_nanosecond();
+    for (size_t i = 0; i < cap; ++i) {
+        sum += map.find(keys[i])->second;
+    }
+    uint64_t end = get_nanosecond();
+    std::cout << name << " entries:" << cap << " average latency with hit:"
+              << 1.0 * (end - begin) / cap << " ns" << std::endl;
+
+    begin = get_nanosecond();
+    for (size_t i = 0; i < cap; ++i) {
+        sum += map.find(keys[i] + static_cast<int64_t>(cap)) == map.end() ? 0 : 1;
+    }
+    end = get_nanosecond();
+    std::cout << name << " entries:" << cap << " average latency with miss:"
+              << 1.0 * (end - begin) / cap << " ns" << std::endl;
+
+    ASSERT_LT(0, sum);
+}
+
+TEST(FlatHashIndexTest, FHIPerformance) {
+    // 默认只测试1M，可通过环境变量FLAT_HASH_INDEX_BENCH_MAX指定更大的规模（如100000000）
+    size_t max_cap = 1000000;
+    const char* env = getenv("FLAT_HASH_INDEX_BENCH_MAX");
+    if (env != nullptr) {
+        max_cap = static_cast<size_t>(strtoull(env, nullptr, 10));
+    }
+
+    for (size_t cap = 1000000; cap <= max_cap; cap *= 10) {
+        bench_lookup<std::unordered_map<int64_t, int64_t>>("unordered_map", cap);
+        bench_lookup<flat_hash_index<int64_t, int64_t>>("flat_hash_index", cap);
+    }
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
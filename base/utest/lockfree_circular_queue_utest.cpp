@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../lockfree_circular_queue.h"
+
+namespace tinycommon {
+namespace base {
+
+TEST(LockfreeCircularQueueTest, LFCQPushAndPop) {
+    lockfree_circular_queue<int, 8> q;
+    ASSERT_EQ(8U, q.capacity());
+    ASSERT_TRUE(q.empty());
+
+    int tmp = -1;
+    ASSERT_FALSE(q.try_pop(tmp));
+
+    // 队列满时push失败，不覆盖
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+        ASSERT_EQ(static_cast<size_t >(i + 1), q.size());
+    }
+    ASSERT_FALSE(q.try_push(8));
+
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(q.try_pop(tmp));
+        ASSERT_EQ(i, tmp);
+    }
+    ASSERT_FALSE(q.try_pop(tmp));
+    ASSERT_TRUE(q.empty());
+
+    // 多圈读写
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+        ASSERT_TRUE(q.try_pop(tmp));
+        ASSERT_EQ(i, tmp);
+    }
+}
+
+TEST(LockfreeCircularQueueTest, LFCQMoveOnly) {
+    lockfree_circular_queue<std::unique_ptr<int>, 4> q;
+    ASSERT_TRUE(q.try_push(std::unique_ptr<int>(new int(7))));
+
+    std::unique_ptr<int> tmp;
+    ASSERT_TRUE(q.try_pop(tmp));
+    ASSERT_EQ(7, *tmp);
+}
+
+TEST(LockfreeCircularQueueTest, LFCQConcurrent) {
+    // 多生产者多消费者，每个对象恰好被取出一次
+    const int producers = 4;
+    const int consumers = 4;
+    const int n = 100000;
+    lockfree_circular_queue<int, 64> q;
+
+    std::vector<std::atomic<int>> seen(producers * n);
+    for (auto& s : seen) {
+        s.store(0);
+    }
+    std::atomic<int> consumed(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p]() {
+            for (int i = 0; i < n; ++i) {
+                while (!q.try_push(p * n + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            int v;
+            while (consumed.load() < producers * n) {
+                if (q.try_pop(v)) {
+                    seen[v].fetch_add(1);
+                    consumed.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < producers * n; ++i) {
+        ASSERT_EQ(1, seen[i].load());
+    }
+    ASSERT_TRUE(q.empty());
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -1,11 +1,18 @@
 #include <assert.h>
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <iostream>
 #include <stdint.h>
 #include <string>
 #include <sys/time.h>
+#include <thread>
+#include <vector>
 
 #include "../lru_cache.h"
 
@@ -18,8 +25,36 @@ uint64_t get_microsecond() {
     return static_cast<uint64_t>(time_now.tv_nsec);
 }
 
+uint64_t get_nanosecond() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
 TEST(LRUCacheTest, LRUCacheConstruct) {
+    int n = 10;
+    LRU_cache<int, int> lru0(static_cast<size_t >(n));
+    for (int i = 0; i < n; ++i) {
+        lru0.push(i, std::make_shared<int>(i + n));
+    }
+
+    // 复制构造函数
+    LRU_cache<int, int> lru1(lru0);
+    ASSERT_EQ(static_cast<size_t >(n), lru1.size());
+    for (int i = 0; i < n; ++i) {
+        auto tmp = std::make_shared<int>(-1);
+        ASSERT_EQ(1, lru1.get(i, tmp));
+        ASSERT_EQ(i + n, *tmp);
+    }
 
+    // 赋值运算符，拷贝后两个容器互不影响
+    LRU_cache<int, int> lru2(1);
+    lru2 = lru0;
+    ASSERT_EQ(static_cast<size_t >(n), lru2.size());
+    lru2.push(n, std::make_shared<int>(n));
+    ASSERT_EQ(1, lru2.exists(n));
+    ASSERT_EQ(0, lru2.exists(0));
+    ASSERT_EQ(0, lru0.exists(n));
+    ASSERT_EQ(1, lru0.exists(0));
 }
 
 TEST(LRUCacheTest, LRUCachePushAndGet) {
@@ -133,6 +168,512 @@ TEST(LRUCacheTest, LRUCacheTestHitRate) {
 
 }
 
+TEST(LRUCacheTest, LRUCacheGhost) {
+    int n = 10;
+    LRU_cache<int, int> lru5(static_cast<size_t >(n));
+    lru5.set_ghost_size(static_cast<size_t >(n));
+
+    for (int i = 0; i < n * 2; ++i) {
+        lru5.push(i, std::make_shared<int>(i));
+    }
+
+    // 0 ~ n-1 已被淘汰，记录在ghost表中
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(0, lru5.get(i, tmp));
+    }
+    ASSERT_EQ(static_cast<size_t >(n), lru5.get_stats().m_ghost_hit_cnt);
+
+    // 不在ghost表中的key不计数
+    ASSERT_EQ(0, lru5.get(n * 3, tmp));
+    ASSERT_EQ(static_cast<size_t >(n), lru5.get_stats().m_ghost_hit_cnt);
+
+    // 重新压入的key从ghost表中移除
+    lru5.push(0, std::make_shared<int>(0));
+    lru5.reset_stats();
+    ASSERT_EQ(1, lru5.get(0, tmp));
+    ASSERT_EQ(0U, lru5.get_stats().m_ghost_hit_cnt);
+
+    // 关闭ghost表
+    lru5.set_ghost_size(0);
+    ASSERT_EQ(0, lru5.get(1, tmp));
+    ASSERT_EQ(0U, lru5.get_stats().m_ghost_hit_cnt);
+}
+
+TEST(LRUCacheTest, LRUCacheShrink) {
+    int n = 100;
+    LRU_cache<int, int> lru6(static_cast<size_t >(n));
+    for (int i = 0; i < n; ++i) {
+        lru6.push(i, std::make_shared<int>(i));
+    }
+
+    // 下调内存上限后不会立即淘汰
+    lru6.set_max_memory_size(n / 2 * sizeof(int));
+    ASSERT_EQ(static_cast<size_t >(n), lru6.size());
+
+    // 分批淘汰
+    ASSERT_EQ(30U, lru6.shrink(30));
+    ASSERT_EQ(static_cast<size_t >(n - 30), lru6.size());
+    ASSERT_EQ(20U, lru6.shrink(30));
+    ASSERT_EQ(0U, lru6.shrink(30));
+    ASSERT_EQ(static_cast<size_t >(n / 2), lru6.size());
+    ASSERT_EQ(n / 2 * sizeof(int), lru6.get_memory_size());
+
+    for (int i = 0; i < n / 2; ++i) {
+        ASSERT_EQ(0, lru6.exists(i));
+    }
+    for (int i = n / 2; i < n; ++i) {
+        ASSERT_EQ(1, lru6.exists(i));
+    }
+}
+
+TEST(LRUCacheTest, LRUCacheFilter) {
+    int n = 100;
+    LRU_cache<int, int> lru7(static_cast<size_t >(n));
+    lru7.push(-1, std::make_shared<int>(-1));
+    lru7.set_ghost_size(static_cast<size_t >(n));
+    lru7.enable_filter(static_cast<size_t >(n * 2));
+    ASSERT_EQ(1, lru7.exists(-1));
+
+    for (int i = 0; i < n * 2; ++i) {
+        lru7.push(i, std::make_shared<int>(i));
+    }
+
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = n; i < n * 2; ++i) {
+        ASSERT_EQ(1, lru7.exists(i));
+        ASSERT_EQ(1, lru7.get(i, tmp));
+        ASSERT_EQ(i, *tmp);
+    }
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(0, lru7.exists(i));
+    }
+
+    // 从未压入过的key大多被过滤器直接拒绝，命中率统计仍包含这部分请求
+    lru7.reset_stats();
+    for (int i = n * 2; i < n * 12; ++i) {
+        ASSERT_EQ(0, lru7.get(i, tmp));
+    }
+    auto stats = lru7.get_stats();
+    EXPECT_EQ(static_cast<size_t >(n * 10), stats.m_get_cnt + stats.m_filter_reject_cnt);
+    EXPECT_LT(static_cast<size_t >(n * 9), stats.m_filter_reject_cnt);
+    EXPECT_DOUBLE_EQ(0.0, lru7.get_hit_rate());
+
+    // 被淘汰的key保留在ghost表中，经过滤器后仍可统计ghost命中
+    lru7.reset_stats();
+    for (int i = n; i < n * 2; ++i) {
+        ASSERT_EQ(0, lru7.get(i - n, tmp));
+    }
+    EXPECT_EQ(static_cast<size_t >(n), lru7.get_stats().m_ghost_hit_cnt);
+
+    // 拷贝后过滤器一并拷贝
+    LRU_cache<int, int> lru8(lru7);
+    ASSERT_EQ(1, lru8.exists(n));
+    ASSERT_EQ(0, lru8.exists(0));
+}
+
+TEST(LRUCacheTest, LRUCacheFilterAssign) {
+    int n = 100;
+    LRU_cache<int, int> lru(static_cast<size_t >(n));
+    LRU_cache<int, int> same(static_cast<size_t >(n));
+    LRU_cache<int, int> other(static_cast<size_t >(n));
+    LRU_cache<int, int> none(static_cast<size_t >(n));
+    lru.enable_filter(static_cast<size_t >(n));
+    same.enable_filter(static_cast<size_t >(n));
+    other.enable_filter(static_cast<size_t >(n * 4));
+    for (int i = 0; i < n; ++i) {
+        lru.push(i, std::make_shared<int>(i));
+        same.push(i, std::make_shared<int>(i));
+        other.push(i, std::make_shared<int>(i));
+        none.push(i, std::make_shared<int>(i));
+    }
+
+    // 赋值时其他线程无锁读取过滤器，过滤器被替换或原地复制都不能使读取方访问已释放的内存
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&lru, &stop, n]() {
+            auto tmp = std::make_shared<int>(-1);
+            while (!stop.load()) {
+                for (int i = 0; i < n; ++i) {
+                    ASSERT_EQ(1, lru.exists(i));
+                    ASSERT_EQ(1, lru.get(i, tmp));
+                    ASSERT_EQ(i, *tmp);
+                    ASSERT_EQ(0, lru.exists(i + n));
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 100; ++round) {
+        lru = same;
+        lru = other;
+        lru = none;
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    lru = other;
+    ASSERT_EQ(1, lru.exists(0));
+    ASSERT_EQ(0, lru.exists(n));
+}
+
+TEST(LRUCacheTest, LRUCacheCursor) {
+    int n = 100;
+    LRU_cache<int, int> lru10(static_cast<size_t >(n));
+    for (int i = 0; i < n; ++i) {
+        lru10.push(i, std::make_shared<int>(i));
+    }
+
+    // 按最近使用顺序分批遍历
+    std::vector<LRU_cache<int, int>::recency_entry> out;
+    {
+        auto cursor = lru10.open_cursor();
+        ASSERT_EQ(true, cursor.is_open());
+        while (lru10.next_chunk(cursor, 30, out) != 0) {
+        }
+    }
+    ASSERT_EQ(static_cast<size_t >(n), out.size());
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(n - 1 - i, out[i].m_key);
+        EXPECT_EQ(n - 1 - i, *out[i].m_value);
+        EXPECT_EQ(static_cast<size_t >(i), out[i].m_rank);
+    }
+
+    // 两批之间并发修改：游标所在元素被访问、被淘汰，均不影响遍历
+    out.clear();
+    auto cursor = lru10.open_cursor();
+    ASSERT_EQ(10U, lru10.next_chunk(cursor, 10, out));     // 99 ~ 90
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, lru10.get(89, tmp));                       // 游标所在元素被移动到队头
+    lru10.push(88, std::make_shared<int>(-88));             // 游标所在元素被更新
+    for (int i = n; i < n + 10; ++i) {                      // 淘汰0 ~ 9
+        lru10.push(i, std::make_shared<int>(i));
+    }
+    while (lru10.next_chunk(cursor, 10, out) != 0) {
+    }
+    ASSERT_EQ(static_cast<size_t >(10 + 78), out.size());    // 87 ~ 10
+    EXPECT_EQ(87, out[10].m_key);
+    EXPECT_EQ(10, out.back().m_key);
+
+    // 淘汰游标所在的元素
+    out.clear();
+    auto cursor1 = lru10.open_cursor();
+    while (lru10.next_chunk(cursor1, 1, out) != 0 && out.back().m_key != 11) {
+    }
+    out.clear();
+    lru10.push(n + 10, std::make_shared<int>(0));          // 淘汰10，游标移动到末尾
+    ASSERT_EQ(0U, lru10.next_chunk(cursor1, 50, out));
+    cursor1.close();
+    ASSERT_EQ(false, cursor1.is_open());
+}
+
+TEST(LRUCacheTest, LRUCacheHotKeys) {
+    LRU_cache<int, int> lru11(100);
+    ASSERT_EQ(0U, lru11.get_hot_keys(10).size());
+
+    lru11.enable_hot_key_tracking(16, 1);
+    for (int i = 0; i < 100; ++i) {
+        lru11.push(i, std::make_shared<int>(i));
+    }
+
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = 0; i < 10000; ++i) {
+        lru11.get(i % 10 == 0 ? 7 : i % 100, tmp);
+    }
+
+    auto hot = lru11.get_hot_keys(1);
+    ASSERT_EQ(1U, hot.size());
+    EXPECT_EQ(7, hot[0].m_key);
+    EXPECT_LE(1000U, hot[0].m_count);
+}
+
+TEST(LRUCacheTest, LRUCacheDiscardCallback) {
+    LRU_cache<int, int> lru12(10);
+    std::vector<int> discarded;
+    lru12.set_discard_callback([&discarded](const int& key, const std::shared_ptr<int>& value) {
+        ASSERT_EQ(key + 100, *value);
+        discarded.push_back(key);
+    });
+
+    for (int i = 0; i < 15; ++i) {
+        lru12.push(i, std::make_shared<int>(i + 100));
+    }
+    ASSERT_EQ(5U, discarded.size());
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(i, discarded[i]);
+    }
+
+    // shrink淘汰的元素同样回调
+    lru12.set_max_memory_size(7 * sizeof(int));
+    EXPECT_EQ(3U, lru12.shrink(10));
+    ASSERT_EQ(8U, discarded.size());
+    EXPECT_EQ(7, discarded[7]);
+
+    // 取消回调
+    lru12.set_discard_callback(nullptr);
+    lru12.set_max_memory_size(4 * sizeof(int));
+    EXPECT_EQ(3U, lru12.shrink(10));
+    EXPECT_EQ(8U, discarded.size());
+    EXPECT_EQ(4U, lru12.size());
+}
+
+TEST(LRUCacheTest, LRUCacheTryGet) {
+    LRU_cache<int, int> lru13(10);
+    lru13.push(1, std::make_shared<int>(1));
+
+    bool busy = true;
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, lru13.try_get(1, tmp, busy));
+    ASSERT_FALSE(busy);
+    ASSERT_EQ(1, *tmp);
+    ASSERT_EQ(0, lru13.try_get(2, tmp, busy));
+    ASSERT_FALSE(busy);
+
+    // 淘汰回调占用锁期间，try_get立即返回
+    std::atomic<bool> in_callback(false);
+    std::atomic<bool> release(false);
+    lru13.set_discard_callback([&](const int&, const std::shared_ptr<int>&) {
+        in_callback = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    std::thread evictor([&lru13]() {
+        for (int i = 2; i <= 11; ++i) {
+            lru13.push(i, std::make_shared<int>(i));
+        }
+    });
+    while (!in_callback) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(0, lru13.try_get(1, tmp, busy));
+    ASSERT_TRUE(busy);
+
+    release = true;
+    evictor.join();
+    ASSERT_EQ(1, lru13.try_get(11, tmp, busy));
+    ASSERT_FALSE(busy);
+    EXPECT_EQ(3U, lru13.get_stats().m_get_cnt);
+}
+
+TEST(LRUCacheTest, LRUCachePushIfAbsent) {
+    LRU_cache<int, int> lru16(2);
+    ASSERT_TRUE(lru16.push_if_absent(0, std::make_shared<int>(0)));
+    ASSERT_FALSE(lru16.push_if_absent(0, std::make_shared<int>(1)));
+
+    // pred返回false时不压入
+    ASSERT_FALSE(lru16.push_if_absent(1, std::make_shared<int>(1), []() { return false; }));
+    ASSERT_EQ(0, lru16.exists(1));
+    ASSERT_TRUE(lru16.push_if_absent(1, std::make_shared<int>(1), []() { return true; }));
+
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, lru16.get(0, tmp));
+    ASSERT_EQ(0, *tmp);
+
+    // 压入后同样按容量淘汰
+    ASSERT_TRUE(lru16.push_if_absent(2, std::make_shared<int>(2)));
+    ASSERT_EQ(2U, lru16.size());
+    ASSERT_EQ(0, lru16.exists(1));
+}
+
+TEST(LRUCacheTest, LRUCacheRelaxedStats) {
+    int n = 100;
+    LRU_cache<int, int> lru14(static_cast<size_t >(n));
+    ASSERT_DOUBLE_EQ(0.0, lru14.hit_rate_relaxed());
+    ASSERT_DOUBLE_EQ(0.0, lru14.hit_rate_window());
+
+    for (int i = 0; i < n * 2; ++i) {
+        lru14.push(i, std::make_shared<int>(i));
+        ASSERT_EQ(lru14.size(), lru14.size_relaxed());
+    }
+
+    // 单线程下与加锁的结果一致
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = 0; i < n * 2; ++i) {
+        lru14.get(i, tmp);
+    }
+    EXPECT_DOUBLE_EQ(lru14.get_hit_rate(), lru14.hit_rate_relaxed());
+    EXPECT_DOUBLE_EQ(0.5, lru14.hit_rate_relaxed());
+
+    lru14.shrink(0);
+    LRU_cache<int, int> lru15(lru14);
+    EXPECT_EQ(static_cast<size_t >(n), lru15.size_relaxed());
+    EXPECT_DOUBLE_EQ(0.5, lru15.hit_rate_relaxed());
+
+    lru14.reset_stats();
+    EXPECT_DOUBLE_EQ(0.0, lru14.hit_rate_relaxed());
+
+    // 窗口命中率只反映最近的get
+    lru14.set_hit_rate_window(std::chrono::milliseconds(160));
+    lru14.hit_rate_window();
+    for (int i = 0; i < 1000; ++i) {
+        lru14.get(n + i % n, tmp);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_DOUBLE_EQ(1.0, lru14.hit_rate_window());
+
+    // 之后只有未命中，轮询超过一个窗口后，窗口命中率降为0，累计命中率不受窗口影响
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            lru14.get(-1 - i, tmp);
+        }
+        lru14.hit_rate_window();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_DOUBLE_EQ(0.0, lru14.hit_rate_window());
+    EXPECT_DOUBLE_EQ(1000.0 / 21000.0, lru14.hit_rate_relaxed());
+}
+
+TEST(LRUCacheTest, LRUCacheRelaxedStatsResetWindow) {
+    LRU_cache<int, int> lru18(100);
+    for (int i = 0; i < 100; ++i) {
+        lru18.push(i, std::make_shared<int>(i));
+    }
+    lru18.set_hit_rate_window(std::chrono::milliseconds(160));
+
+    // reset_stats之前记录的快照不参与之后的窗口命中率，即使计数已超过快照中的值
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = 0; i < 100; ++i) {
+        lru18.get(i, tmp);
+    }
+    lru18.hit_rate_window();
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+
+    lru18.reset_stats();
+    lru18.hit_rate_window();
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    for (int i = 0; i < 300; ++i) {
+        lru18.get(i % 2 == 0 ? i % 100 : -1 - i, tmp);
+    }
+    EXPECT_DOUBLE_EQ(0.5, lru18.hit_rate_window());
+}
+
+TEST(LRUCacheTest, LRUCacheRelaxedStatsReset) {
+    LRU_cache<int, int> lru17(100);
+    for (int i = 0; i < 100; ++i) {
+        lru17.push(i, std::make_shared<int>(i));
+    }
+
+    // 全部命中的get与reset_stats并发，无锁读到的命中率不会大于1
+    std::atomic<bool> stop(false);
+    std::atomic<int> bad(0);
+    std::thread poller([&]() {
+        while (!stop) {
+            double rate = lru17.hit_rate_relaxed();
+            double window = lru17.hit_rate_window();
+            if (rate > 1.0 || window > 1.0) {
+                ++bad;
+            }
+        }
+    });
+    auto tmp = std::make_shared<int>(-1);
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            lru17.get(i, tmp);
+        }
+        lru17.reset_stats();
+    }
+    stop = true;
+    poller.join();
+    EXPECT_EQ(0, bad.load());
+}
+
+/// 将当前线程绑定到第cpu个CPU上，CPU个数不足时不绑定
+void pin_to_cpu(unsigned cpu) {
+    if (std::thread::hardware_concurrency() <= cpu) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+struct polling_result {
+    uint64_t    m_get_ns;   // 读线程每次get的平均耗时
+    uint64_t    m_polls;    // 轮询线程的总轮询次数
+    uint64_t    m_poll_ns;  // 每次轮询的平均耗时
+};
+
+/// 读线程get的同时，pollers个线程各自每隔约1us调用一次poll；
+/// 轮询频率固定，各线程分别绑定到不同的CPU（CPU足够时），读线程的耗时只反映轮询带来的锁与cache line竞争
+template <typename Poll>
+polling_result bench_get_with_pollers(int pollers, Poll poll) {
+    const int n = 500000;
+    LRU_cache<int, int> lru(1000);
+    for (int i = 0; i < 1000; ++i) {
+        lru.push(i, std::make_shared<int>(i));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> sink(0);
+    std::atomic<uint64_t> polls(0);
+    std::atomic<uint64_t> poll_ns(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < pollers; ++i) {
+        threads.emplace_back([&, i]() {
+            pin_to_cpu(static_cast<unsigned>(i + 1));
+            double sum = 0;
+            uint64_t count = 0;
+            std::chrono::steady_clock::duration busy(0);
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto begin = std::chrono::steady_clock::now();
+                sum += poll(lru);
+                busy += std::chrono::steady_clock::now() - begin;
+                ++count;
+                std::this_thread::sleep_for(std::chrono::microseconds(1));
+            }
+            sink += static_cast<int>(sum > 0);
+            polls += count;
+            poll_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count());
+        });
+    }
+
+    uint64_t elapsed = 0;
+    std::thread reader([&]() {
+        pin_to_cpu(0);
+        auto tmp = std::make_shared<int>(-1);
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            lru.get(i % 2000, tmp);
+        }
+        auto end = std::chrono::steady_clock::now();
+        elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    });
+    reader.join();
+
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    return polling_result{elapsed / n, polls.load(), polls.load() == 0 ? 0 : poll_ns.load() / polls.load()};
+}
+
+TEST(LRUCacheTest, LRUCachePollingPerformance) {
+    typedef LRU_cache<int, int> cache_type;
+    polling_result idle = bench_get_with_pollers(0, [](const cache_type& c) { return c.get_hit_rate(); });
+    polling_result locked = bench_get_with_pollers(3, [](const cache_type& c) {
+        return c.get_hit_rate() + static_cast<double>(c.size());
+    });
+    polling_result relaxed = bench_get_with_pollers(3, [](const cache_type& c) {
+        return c.hit_rate_relaxed() + c.hit_rate_window() + static_cast<double>(c.size_relaxed());
+    });
+
+    std::cout << "get latency, no pollers: " << idle.m_get_ns << " ns"
+              << ", polling get_hit_rate()/size(): " << locked.m_get_ns << " ns"
+              << ", polling relaxed stats: " << relaxed.m_get_ns << " ns"
+              << ", locked - relaxed: " << static_cast<int64_t>(locked.m_get_ns - relaxed.m_get_ns) << " ns"
+              << std::endl;
+    std::cout << "poll latency, get_hit_rate()/size(): " << locked.m_poll_ns << " ns (" << locked.m_polls << " polls)"
+              << ", relaxed stats: " << relaxed.m_poll_ns << " ns (" << relaxed.m_polls << " polls)"
+              << std::endl;
+    // 无锁读取不会等待读线程释放锁
+    EXPECT_LT(relaxed.m_poll_ns, locked.m_poll_ns);
+}
+
 TEST(LRUCacheTest, LRUCachePerformance) {
     const int cap = 3000000;
 
@@ -187,6 +728,59 @@ TEST(LRUCacheTest, LRUCachePerformance) {
 
     std::cout << "average latency with get not exists elements:"
               << 1.0 * totalTime / cap << " us" << std::endl;
+
+    LRU_cache<int, int> lru9(static_cast<size_t >(cap));
+    lru9.enable_filter(static_cast<size_t >(cap));
+    for (int i = 0; i < cap; ++i) {
+        lru9.push(i, std::make_shared<int>(i));
+    }
+
+    totalTime = 0;
+    for (int i = cap; i < cap * 2; ++i) {
+        auto tmp = std::make_shared<int>(-1);
+        uint64_t begin = get_nanosecond();
+        lru9.get(i, tmp);
+        uint64_t end = get_nanosecond();
+
+        totalTime += end - begin;
+    }
+
+    std::cout << "average latency with get not exists elements (filter):"
+              << 1.0 * totalTime / cap << " ns" << std::endl;
+
+    lru4.enable_hot_key_tracking(64);
+    totalTime = 0;
+    for (int i = cap; i < cap * 2; ++i) {
+        auto tmp = std::make_shared<int>(-1);
+        uint64_t begin = get_nanosecond();
+        lru4.get(i, tmp);
+        uint64_t end = get_nanosecond();
+
+        totalTime += end - begin;
+    }
+
+    std::cout << "average latency with get exists elements (hot key tracking):"
+              << 1.0 * totalTime / cap << " ns" << std::endl;
+
+    // 遍历期间持有锁的时间只与每批的大小有关
+    std::vector<LRU_cache<int, int>::recency_entry> out;
+    auto cursor = lru4.open_cursor();
+    uint64_t maxTime = 0;
+    size_t chunks = 0;
+    while (true) {
+        out.clear();
+        uint64_t begin = get_nanosecond();
+        size_t n = lru4.next_chunk(cursor, 1024, out);
+        uint64_t end = get_nanosecond();
+        if (n == 0) {
+            break;
+        }
+        maxTime = std::max(maxTime, end - begin);
+        ++chunks;
+    }
+
+    std::cout << "max latency of next_chunk(1024) over " << chunks << " chunks:"
+              << maxTime << " ns" << std::endl;
 }
 
 }// namespace common
@@ -0,0 +1,232 @@
+#include <assert.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "../memory_governor.h"
+
+namespace tinycommon {
+namespace base {
+
+TEST(MemoryGovernorTest, MGRegister) {
+    const size_t budget = 1000 * sizeof(int);
+    memory_governor governor(budget);
+
+    auto lru0 = std::make_shared<LRU_cache<int, int>>(100000);
+    auto lru1 = std::make_shared<LRU_cache<int, int>>(100000);
+
+    auto h0 = governor.register_cache(lru0);
+    ASSERT_EQ(budget, governor.get_memory_limit(h0));
+    ASSERT_EQ(budget, lru0->get_max_memory_size());
+
+    // 新注册的缓存平分预算
+    auto h1 = governor.register_cache(lru1);
+    ASSERT_EQ(budget / 2, governor.get_memory_limit(h0));
+    ASSERT_EQ(budget / 2, governor.get_memory_limit(h1));
+
+    // 取消注册后，释放的内存归还给其余缓存
+    ASSERT_EQ(true, governor.unregister_cache(h1));
+    ASSERT_EQ(false, governor.unregister_cache(h1));
+    ASSERT_EQ(budget, governor.get_memory_limit(h0));
+}
+
+/// 只记录上限的缓存，用于检查预算的分配
+class fake_governed_cache : public governed_cache
+{
+public:
+    size_type   m_limit = 0;
+    size_type   m_ghost_hit = 0;
+
+    size_type memory_size() const override { return 0; }
+    size_type memory_limit() const override { return m_limit; }
+    void set_memory_limit(size_type limit) override { m_limit = limit; }
+    size_type entry_size() const override { return 1; }
+    void set_ghost_size(size_type) override {}
+    size_type ghost_hit_count() const override { return m_ghost_hit; }
+    size_type shrink(size_type) override { return 0; }
+};
+
+TEST(MemoryGovernorTest, MGBudgetInvariant) {
+    const size_t budget = 1001;
+    memory_governor::Options options;
+    options.m_step_bytes = 1000;
+    options.m_min_bytes = 100;
+    options.m_evict_batch = 64;
+    memory_governor governor(budget, options);
+
+    std::vector<std::shared_ptr<fake_governed_cache>> caches;
+    std::vector<memory_governor::handle_type> handles;
+    auto total = [&caches]() {
+        size_t sum = 0;
+        for (auto& c : caches) {
+            sum += c->m_limit;
+        }
+        return sum;
+    };
+    auto add = [&]() {
+        auto cache = std::make_shared<fake_governed_cache>();
+        auto handle = governor.register_cache(cache);
+        if (handle != memory_governor::invalid_handle()) {
+            caches.push_back(cache);
+            handles.push_back(handle);
+        }
+        return handle != memory_governor::invalid_handle();
+    };
+
+    ASSERT_TRUE(add());
+    ASSERT_TRUE(add());
+    ASSERT_EQ(budget, total());
+
+    // 第二个缓存的内存全部移给第一个，降到下限
+    caches[0]->m_ghost_hit = 10;
+    ASSERT_EQ(budget / 2 + 1 - options.m_min_bytes, governor.rebalance());
+    ASSERT_EQ(options.m_min_bytes, caches[1]->m_limit);
+
+    // 按比例缩小不足以腾出空间时，差额由上限最大的缓存承担
+    ASSERT_TRUE(add());
+    EXPECT_EQ(budget, total());
+    for (auto& c : caches) {
+        EXPECT_LE(options.m_min_bytes, c->m_limit);
+    }
+    EXPECT_LE(budget / 3, caches[2]->m_limit);
+
+    // 预算不足以使每个缓存保留下限时拒绝注册，已有缓存不受影响
+    for (int i = 0; i < 7; ++i) {
+        ASSERT_TRUE(add());
+        ASSERT_EQ(budget, total());
+    }
+    std::vector<size_t> before;
+    for (auto& c : caches) {
+        before.push_back(c->m_limit);
+    }
+    ASSERT_FALSE(add());
+    EXPECT_EQ(memory_governor::invalid_handle(), governor.register_cache(std::make_shared<fake_governed_cache>()));
+    for (size_t i = 0; i < caches.size(); ++i) {
+        EXPECT_EQ(before[i], caches[i]->m_limit);
+    }
+
+    // 取消注册时除不尽的部分也分配出去
+    while (caches.size() > 1) {
+        ASSERT_TRUE(governor.unregister_cache(handles.back()));
+        caches.pop_back();
+        handles.pop_back();
+        ASSERT_EQ(budget, total());
+    }
+    EXPECT_EQ(budget, caches[0]->m_limit);
+}
+
+TEST(MemoryGovernorTest, MGRebalance) {
+    const size_t budget = 2000 * sizeof(int);
+    memory_governor::Options options;
+    options.m_step_bytes = 100 * sizeof(int);
+    options.m_min_bytes = 100 * sizeof(int);
+    options.m_evict_batch = 64;
+    memory_governor governor(budget, options);
+
+    auto hot = std::make_shared<LRU_cache<int, int>>(100000);
+    auto cold = std::make_shared<LRU_cache<int, int>>(100000);
+    auto h_hot = governor.register_cache(hot);
+    auto h_cold = governor.register_cache(cold);
+
+    // hot的工作集为1050个元素，略大于其1000个元素的上限，ghost命中较多
+    // cold只访问少量元素，没有ghost命中
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 1050; ++i) {
+            hot->push(i, std::make_shared<int>(i));
+        }
+        for (int i = 0; i < 1050; ++i) {
+            auto tmp = std::make_shared<int>(-1);
+            hot->get(i, tmp);
+        }
+        for (int i = 0; i < 10; ++i) {
+            cold->push(i, std::make_shared<int>(i));
+            auto tmp = std::make_shared<int>(-1);
+            cold->get(i, tmp);
+        }
+    }
+    ASSERT_LT(0U, hot->get_stats().m_ghost_hit_cnt);
+    ASSERT_EQ(0U, cold->get_stats().m_ghost_hit_cnt);
+
+    ASSERT_EQ(options.m_step_bytes, governor.rebalance());
+    EXPECT_EQ(budget / 2 + options.m_step_bytes, governor.get_memory_limit(h_hot));
+    EXPECT_EQ(budget / 2 - options.m_step_bytes, governor.get_memory_limit(h_cold));
+
+    // 无新的ghost命中时不移动内存
+    ASSERT_EQ(0U, governor.rebalance());
+
+    // 上限之和不超过总预算
+    EXPECT_EQ(budget, governor.get_memory_limit(h_hot) + governor.get_memory_limit(h_cold));
+}
+
+TEST(MemoryGovernorTest, MGIncrementalEvict) {
+    const size_t budget = 1000 * sizeof(int);
+    memory_governor::Options options;
+    options.m_step_bytes = 10 * sizeof(int);
+    options.m_min_bytes = 10 * sizeof(int);
+    options.m_evict_batch = 100;
+    memory_governor governor(budget, options);
+
+    auto lru0 = std::make_shared<LRU_cache<int, int>>(100000);
+    governor.register_cache(lru0);
+    for (int i = 0; i < 1000; ++i) {
+        lru0->push(i, std::make_shared<int>(i));
+    }
+    ASSERT_EQ(1000U, lru0->size());
+
+    // 注册第二个缓存后lru0上限减半，每次evict_step至多淘汰m_evict_batch个元素
+    auto lru1 = std::make_shared<LRU_cache<int, int>>(100000);
+    governor.register_cache(lru1);
+    ASSERT_EQ(1000U, lru0->size());
+
+    size_t steps = 0;
+    size_t discarded = 0;
+    size_t n = 0;
+    while ((n = governor.evict_step()) != 0) {
+        ASSERT_LE(n, options.m_evict_batch);
+        discarded += n;
+        ++steps;
+    }
+    EXPECT_EQ(500U, discarded);
+    EXPECT_EQ(5U, steps);
+    EXPECT_EQ(500U, lru0->size());
+
+    // 淘汰的是最旧的元素
+    EXPECT_EQ(false, lru0->exists(499));
+    EXPECT_EQ(true, lru0->exists(500));
+}
+
+TEST(MemoryGovernorTest, MGBackgroundThread) {
+    const size_t budget = 1000 * sizeof(int);
+    memory_governor governor(budget);
+
+    auto lru0 = std::make_shared<LRU_cache<int, int>>(100000);
+    governor.register_cache(lru0);
+    for (int i = 0; i < 1000; ++i) {
+        lru0->push(i, std::make_shared<int>(i));
+    }
+
+    auto lru1 = std::make_shared<LRU_cache<int, int>>(100000);
+    governor.register_cache(lru1);
+
+    governor.start(std::chrono::milliseconds(1));
+    for (int i = 0; i < 1000 && lru0->size() > 500; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    governor.stop();
+
+    EXPECT_EQ(500U, lru0->size());
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../lru_cache.h"
+#include "../object_pool.h"
+
+namespace tinycommon {
+namespace base {
+
+struct message_buffer {
+    size_t  m_len = 0;
+    char    m_data[4096];
+};
+
+uint64_t get_nanosecond() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TEST(ObjectPoolTest, ObjectPoolReuse) {
+    object_pool<message_buffer> pool([](message_buffer& buf) { buf.m_len = 0; });
+
+    message_buffer* first = nullptr;
+    {
+        auto buf = pool.make_unique();
+        buf->m_len = 100;
+        first = buf.get();
+    }
+
+    // 归还后再次获取的是同一个对象，且已被重置
+    auto buf = pool.make_unique();
+    ASSERT_EQ(first, buf.get());
+    ASSERT_EQ(0U, buf->m_len);
+
+    auto shared = pool.make_shared();
+    ASSERT_NE(first, shared.get());
+    shared.reset();
+
+    message_buffer* raw = pool.acquire();
+    pool.release(raw);
+
+    auto stats = pool.get_stats();
+    EXPECT_EQ(2U, stats.m_create_cnt);
+    EXPECT_EQ(2U, stats.m_reuse_cnt);
+    EXPECT_EQ(0U, stats.m_destroy_cnt);
+}
+
+TEST(ObjectPoolTest, ObjectPoolBounded) {
+    object_pool<int, 4> pool;
+    std::vector<object_pool<int, 4>::unique_ptr_type> objs;
+    for (int i = 0; i < 100; ++i) {
+        objs.push_back(pool.make_unique());
+    }
+    objs.clear();
+
+    // 本地缓存与共享队列都满后直接释放
+    auto stats = pool.get_stats();
+    EXPECT_EQ(100U, stats.m_create_cnt);
+    EXPECT_LT(0U, stats.m_destroy_cnt);
+    EXPECT_GE(4U, pool.idle_size());
+}
+
+TEST(ObjectPoolTest, ObjectPoolOutlive) {
+    // 池先于对象析构，对象仍可安全释放
+    std::shared_ptr<int> obj;
+    {
+        object_pool<int> pool;
+        obj = pool.make_shared();
+        *obj = 1;
+    }
+    obj.reset();
+}
+
+/// 统计存活个数的对象
+struct counted_object {
+    static std::atomic<int> s_live;
+
+    counted_object() { ++s_live; }
+    ~counted_object() { --s_live; }
+};
+
+std::atomic<int> counted_object::s_live(0);
+
+TEST(ObjectPoolTest, ObjectPoolDestroy) {
+    // 池析构后，本地缓存与共享队列中的对象都被释放
+    {
+        object_pool<counted_object> pool;
+        std::vector<object_pool<counted_object>::unique_ptr_type> objs;
+        for (int i = 0; i < 100; ++i) {
+            objs.push_back(pool.make_unique());
+        }
+        objs.clear();
+        ASSERT_EQ(100, counted_object::s_live.load());
+    }
+    ASSERT_EQ(0, counted_object::s_live.load());
+
+    // 池先于对象析构，最后一个对象归还后池中的对象都被释放
+    {
+        std::shared_ptr<counted_object> obj;
+        std::shared_ptr<counted_object> other;
+        {
+            object_pool<counted_object> pool;
+            obj = pool.make_shared();
+            other = pool.make_shared();
+        }
+        other.reset();
+        ASSERT_EQ(2, counted_object::s_live.load());
+        obj.reset();
+    }
+    ASSERT_EQ(0, counted_object::s_live.load());
+
+    // 其他线程的本地缓存不延长池的生命周期，线程退出时释放其中的对象
+    {
+        std::unique_ptr<object_pool<counted_object>> pool(new object_pool<counted_object>());
+        std::atomic<int> step(0);
+        std::thread worker([&pool, &step]() {
+            pool->release(pool->acquire());
+            step = 1;
+            while (step.load() != 2) {
+                std::this_thread::yield();
+            }
+        });
+        while (step.load() != 1) {
+            std::this_thread::yield();
+        }
+        pool.reset();
+        ASSERT_EQ(1, counted_object::s_live.load());
+        step = 2;
+        worker.join();
+    }
+    ASSERT_EQ(0, counted_object::s_live.load());
+}
+
+TEST(ObjectPoolTest, ObjectPoolLRUValue) {
+    object_pool<int> pool;
+    LRU_cache<int, int> lru(10);
+    for (int i = 0; i < 1000; ++i) {
+        auto value = pool.make_shared();
+        *value = i;
+        lru.push(i, value);
+    }
+
+    // 被淘汰的value归还到池中复用
+    EXPECT_GE(20U, pool.get_stats().m_create_cnt);
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, lru.get(999, tmp));
+    ASSERT_EQ(999, *tmp);
+}
+
+TEST(ObjectPoolTest, ObjectPoolConcurrent) {
+    object_pool<message_buffer> pool;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t]() {
+            std::vector<std::shared_ptr<message_buffer>> live;
+            for (int i = 0; i < 20000; ++i) {
+                auto buf = pool.make_shared();
+                buf->m_len = static_cast<size_t >(t);
+                live.push_back(buf);
+                // 保持一部分对象存活，释放顺序与获取顺序不同
+                if (live.size() > 16) {
+                    ASSERT_EQ(static_cast<size_t >(t), live.front()->m_len);
+                    live.erase(live.begin());
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto stats = pool.get_stats();
+    EXPECT_EQ(80000U, stats.m_create_cnt + stats.m_reuse_cnt);
+    EXPECT_GT(stats.m_reuse_cnt, stats.m_create_cnt);
+}
+
+/// 保持live个对象存活，每次替换其中一个，返回每次替换的延迟
+template <typename Alloc>
+std::vector<uint64_t> bench_alloc(Alloc alloc, size_t live, size_t n) {
+    std::vector<std::shared_ptr<message_buffer>> objs(live);
+    std::vector<uint64_t> latency;
+    latency.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t begin = get_nanosecond();
+        objs[i % live] = alloc();
+        objs[i % live]->m_len = i;
+        uint64_t end = get_nanosecond();
+        latency.push_back(end - begin);
+    }
+    std::sort(latency.begin(), latency.end());
+    return latency;
+}
+
+TEST(ObjectPoolTest, ObjectPoolPerformance) {
+    const size_t live = 256;
+    const size_t n = 1000000;
+
+    auto plain = bench_alloc([]() { return std::make_shared<message_buffer>(); }, live, n);
+
+    object_pool<message_buffer> pool;
+    auto pooled = bench_alloc([&pool]() { return pool.make_shared(); }, live, n);
+
+    auto avg = [](const std::vector<uint64_t>& v) {
+        uint64_t sum = 0;
+        for (auto x : v) {
+            sum += x;
+        }
+        return 1.0 * sum / v.size();
+    };
+    std::cout << "make_shared: avg " << avg(plain) << " ns, p99 " << plain[n * 99 / 100]
+              << " ns, objects created " << n << std::endl;
+    std::cout << "object_pool: avg " << avg(pooled) << " ns, p99 " << pooled[n * 99 / 100]
+              << " ns, objects created " << pool.get_stats().m_create_cnt << std::endl;
+
+    EXPECT_GE(live + 1, pool.get_stats().m_create_cnt);
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+
+#include "../space_saving.h"
+
+namespace tinycommon {
+namespace base {
+
+TEST(SpaceSavingTest, SSExact) {
+    // 不同key的个数不超过容量时，计数准确
+    space_saving<int> ss(10);
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            ss.offer(i);
+        }
+    }
+    ASSERT_EQ(55U, ss.total());
+
+    auto top = ss.top(3);
+    ASSERT_EQ(3U, top.size());
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(9 - i, top[i].m_key);
+        EXPECT_EQ(static_cast<size_t>(10 - i), top[i].m_count);
+        EXPECT_EQ(0U, top[i].m_error);
+    }
+
+    // N大于计数器个数
+    ASSERT_EQ(10U, ss.top(100).size());
+
+    ss.clear();
+    ASSERT_EQ(0U, ss.top(10).size());
+    ASSERT_EQ(0U, ss.total());
+}
+
+TEST(SpaceSavingTest, SSHeavyHitter) {
+    // 3个热点key各占约20%，其余为大量只出现一次的key
+    space_saving<int> ss(16);
+    int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        if (i % 5 < 3) {
+            ss.offer(-(i % 5) - 1);
+        } else {
+            ss.offer(i);
+        }
+    }
+
+    auto top = ss.top(3);
+    ASSERT_EQ(3U, top.size());
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_GT(0, top[i].m_key);
+        // 估计值不小于真实值，且误差有上界
+        EXPECT_LE(static_cast<size_t>(n / 5), top[i].m_count);
+        EXPECT_LE(top[i].m_count - top[i].m_error, static_cast<size_t>(n / 5));
+    }
+
+    // 带权重的offer
+    space_saving<std::string> ss_str(2);
+    ss_str.offer("a", 10);
+    ss_str.offer("b", 5);
+    ss_str.offer("c", 1);
+    auto top_str = ss_str.top(1);
+    EXPECT_EQ("a", top_str[0].m_key);
+    EXPECT_EQ(10U, top_str[0].m_count);
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../two_tier_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+/// 在/tmp下创建临时目录，析构时删除
+class temp_dir
+{
+public:
+    std::string m_path;
+
+    temp_dir()
+    {
+        char buf[] = "/tmp/two_tier_XXXXXX";
+        m_path = mkdtemp(buf);
+    }
+
+    ~temp_dir()
+    {
+        rmdir(m_path.c_str());
+    }
+};
+
+TEST(TwoTierCacheTest, TwoTierCacheVictim) {
+    temp_dir dir;
+    two_tier_cache<int, int> cache(10, 0, dir.m_path, {4096, 0, 0.5});
+
+    int n = 100;
+    for (int i = 0; i < n; ++i) {
+        cache.push(i, std::make_shared<int>(i));
+    }
+    ASSERT_EQ(10U, cache.memory_tier().size());
+    ASSERT_EQ(static_cast<size_t >(n - 10), cache.file_tier().size());
+
+    // 被淘汰的元素从文件层读回，并提升回内存层
+    auto tmp = std::make_shared<int>(-1);
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(1, cache.get(i, tmp));
+        ASSERT_EQ(i, *tmp);
+    }
+    ASSERT_EQ(0, cache.get(n, tmp));
+    ASSERT_EQ(1, cache.memory_tier().exists(n - 1));
+
+    auto stats = cache.get_stats();
+    EXPECT_EQ(static_cast<size_t >(n + 1), stats.m_get_cnt);
+    EXPECT_EQ(static_cast<size_t >(n), stats.m_memory_hit_cnt + stats.m_tier_hit_cnt);
+    EXPECT_LE(static_cast<size_t >(n - 10), stats.m_tier_hit_cnt);
+
+    // 重新压入后文件层中的旧值失效
+    cache.push(0, std::make_shared<int>(-1));
+    ASSERT_FALSE(cache.file_tier().exists(0));
+    for (int i = 1; i <= 20; ++i) {
+        cache.push(n + i, std::make_shared<int>(n + i));
+    }
+    ASSERT_EQ(1, cache.get(0, tmp));
+    ASSERT_EQ(-1, *tmp);
+}
+
+TEST(TwoTierCacheTest, TwoTierCacheConcurrent) {
+    temp_dir dir;
+    two_tier_cache<int, int> cache(64, 0, dir.m_path, {4096, 0, 0.5});
+    cache.start_compaction(std::chrono::milliseconds(1));
+
+    // 每个线程只写自己的key，value单调递增，读到的值不能小于自己最后写入的值
+    const int threads = 4;
+    const int keys = 200;
+    std::vector<std::thread> workers;
+    std::vector<int> failed(threads, 0);
+    std::vector<std::vector<bool>> pushed(threads, std::vector<bool>(keys, false));
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, &failed, &pushed, t]() {
+            std::vector<int> last(keys, -1);
+            std::mt19937 rng(static_cast<unsigned>(t));
+            auto tmp = std::make_shared<int>(-1);
+            for (int i = 0; i < 20000; ++i) {
+                int k = static_cast<int>(rng() % keys);
+                int key = k * threads + t;
+                if (i % 3 == 0) {
+                    cache.push(key, std::make_shared<int>(i));
+                    last[k] = i;
+                    pushed[t][k] = true;
+                } else if (cache.get(key, tmp)) {
+                    failed[t] += *tmp != last[k];
+                } else {
+                    failed[t] += last[k] != -1;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    cache.stop_compaction();
+
+    for (int t = 0; t < threads; ++t) {
+        EXPECT_EQ(0, failed[t]);
+    }
+
+    // 写入交给其他线程的淘汰元素最终都已写入文件层，不会遗留在待写队列中
+    for (int t = 0; t < threads; ++t) {
+        for (int k = 0; k < keys; ++k) {
+            int key = k * threads + t;
+            if (pushed[t][k]) {
+                EXPECT_TRUE(cache.memory_tier().exists(key) || cache.file_tier().exists(key));
+            }
+        }
+    }
+}
+
+/// 解码可被放慢的int编解码器，用于扩大从文件层读取与并发push之间的时间窗口
+std::atomic<bool> g_slow_decode(false);
+
+struct slow_int_codec
+{
+    static void encode(const int& from, std::string& to)
+    {
+        pod_codec<int>::encode(from, to);
+    }
+
+    static bool decode(const char* data, size_t len, int& to)
+    {
+        if (g_slow_decode) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return pod_codec<int>::decode(data, len, to);
+    }
+};
+
+TEST(TwoTierCacheTest, TwoTierCacheCrossThreadPush) {
+    temp_dir dir;
+    two_tier_cache<int, int, slow_int_codec> cache(1, 0, dir.m_path, {4096, 0, 0.5});
+
+    // 一个线程从文件层读取key 0期间，另一个线程压入新值，读取结束后的提升不能覆盖新值
+    cache.push(0, std::make_shared<int>(1));
+    cache.push(1, std::make_shared<int>(1));
+    ASSERT_TRUE(cache.file_tier().exists(0));
+
+    g_slow_decode = true;
+    std::thread reader([&cache]() {
+        auto tmp = std::make_shared<int>(-1);
+        cache.get(0, tmp);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    cache.push(0, std::make_shared<int>(2));
+    reader.join();
+    g_slow_decode = false;
+
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, cache.get(0, tmp));
+    ASSERT_EQ(2, *tmp);
+
+    // 一个线程持续更新同一批key并制造淘汰，另一个线程读取，结束后读到的均为最后写入的值
+    temp_dir dir2;
+    two_tier_cache<int, int> cache2(8, 0, dir2.m_path, {4096, 0, 0.5});
+    const int keys = 32;
+    const int n = 20000;
+    std::atomic<bool> done(false);
+    std::thread writer([&cache2, &done]() {
+        for (int i = 0; i < n; ++i) {
+            cache2.push(i % keys, std::make_shared<int>(i));
+        }
+        done = true;
+    });
+    std::thread reader2([&cache2, &done]() {
+        auto v = std::make_shared<int>(-1);
+        for (int i = 0; !done; ++i) {
+            cache2.get(i % keys, v);
+        }
+    });
+    writer.join();
+    reader2.join();
+
+    for (int k = 0; k < keys; ++k) {
+        ASSERT_EQ(1, cache2.get(k, tmp));
+        ASSERT_EQ(n - keys + k, *tmp);
+    }
+}
+
+TEST(TwoTierCacheTest, TwoTierCacheBackendLoad) {
+    // 工作集为内存层的10倍，按偏斜分布访问，未命中时从后端读取并压入
+    const int memory = 1000;
+    const int working_set = memory * 10;
+    const int requests = 200000;
+
+    std::mt19937 rng(1);
+    std::vector<int> trace;
+    trace.reserve(requests);
+    for (int i = 0; i < requests; ++i) {
+        // 近似zipf：小key被访问的概率更高
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        trace.push_back(static_cast<int>(working_set * u * u * u));
+    }
+
+    size_t memory_only = 0;
+    {
+        LRU_cache<int, int> cache(memory);
+        auto tmp = std::make_shared<int>(-1);
+        for (int key : trace) {
+            if (!cache.get(key, tmp)) {
+                ++memory_only;
+                cache.push(key, std::make_shared<int>(key));
+            }
+        }
+    }
+
+    size_t two_tier = 0;
+    {
+        temp_dir dir;
+        two_tier_cache<int, int> cache(memory, 0, dir.m_path, {1 << 20, 0, 0.5});
+        cache.start_compaction(std::chrono::milliseconds(10));
+        auto tmp = std::make_shared<int>(-1);
+        for (int key : trace) {
+            if (!cache.get(key, tmp)) {
+                ++two_tier;
+                cache.push(key, std::make_shared<int>(key));
+            } else {
+                ASSERT_EQ(key, *tmp);
+            }
+        }
+    }
+
+    std::cout << "backend fetches, memory only: " << memory_only
+              << ", two tier: " << two_tier << std::endl;
+    // 两级缓存只有首次访问需要读取后端
+    EXPECT_GE(static_cast<size_t >(working_set), two_tier);
+    EXPECT_LT(two_tier * 2, memory_only);
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "../windowed_rate.h"
+
+namespace tinycommon {
+namespace base {
+
+TEST(WindowedRateTest, WindowedRateUpdate) {
+    windowed_rate<4> rate(std::chrono::milliseconds(40));
+
+    // 只有一个快照时窗口内没有增长
+    ASSERT_DOUBLE_EQ(0.0, rate.update(0, 0));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    ASSERT_DOUBLE_EQ(0.5, rate.update(50, 100));
+
+    // 超过一个窗口后，较早的增长不再计入
+    for (int i = 1; i <= 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        rate.update(50 + static_cast<uint64_t>(i) * 10, 100 + static_cast<uint64_t>(i) * 10);
+    }
+    EXPECT_DOUBLE_EQ(1.0, rate.update(150, 200));
+
+    // 计数被重置后，重置之前的快照失效
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    EXPECT_DOUBLE_EQ(0.0, rate.update(0, 10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    EXPECT_DOUBLE_EQ(0.5, rate.update(5, 20));
+}
+
+TEST(WindowedRateTest, WindowedRateStale) {
+    windowed_rate<16> rate(std::chrono::milliseconds(160));
+    rate.update(0, 0);
+
+    // 长时间没有读取时，使用窗口外最新的快照
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_DOUBLE_EQ(0.25, rate.update(25, 100));
+}
+
+TEST(WindowedRateTest, WindowedRateGeneration) {
+    windowed_rate<4> rate(std::chrono::milliseconds(40));
+    rate.update(100, 100, 0);
+
+    // 换代后旧快照失效，即使新的计数已超过旧快照
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    EXPECT_DOUBLE_EQ(0.0, rate.update(0, 0, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    EXPECT_DOUBLE_EQ(0.5, rate.update(150, 300, 1));
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
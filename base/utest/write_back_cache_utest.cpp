@@ -0,0 +1,299 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../write_back_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+/// 进程内的假后端，统计写入次数，并检查同一key的写入值单调递增
+class fake_store
+{
+public:
+    std::mutex          m_mutex;
+    std::map<int, int>  m_data;
+    size_t              m_writes = 0;      // 写入的元素个数
+    size_t              m_batches = 0;     // 写入的批次
+    bool                m_ordered = true;  // 同一key后写入的值不小于先写入的值
+    std::atomic<bool>   m_fail{false};
+
+    write_back_cache<int, int>::batch_writer writer()
+    {
+        return [this](const write_back_cache<int, int>::batch_type& batch) {
+            if (m_fail) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lck (m_mutex);
+            for (auto& kv : batch) {
+                auto ite = m_data.find(kv.first);
+                if (ite != m_data.end() && ite->second > *kv.second) {
+                    m_ordered = false;
+                }
+                m_data[kv.first] = *kv.second;
+            }
+            m_writes += batch.size();
+            ++m_batches;
+            return true;
+        };
+    }
+
+    size_t writes()
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        return m_writes;
+    }
+
+    int value(int key)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        auto ite = m_data.find(key);
+        return ite == m_data.end() ? -1 : ite->second;
+    }
+};
+
+/// 等待cond成立，至多等待1秒
+template <typename Cond>
+bool wait_for(Cond cond)
+{
+    for (int i = 0; i < 1000; ++i) {
+        if (cond()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return cond();
+}
+
+const std::chrono::milliseconds kNever(3600 * 1000);
+
+TEST(WriteBackCacheTest, WriteBackCacheCoalesce) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(), {kNever, 0, 16, 0});
+
+    // 同一key的多次更新合并为一次写入
+    for (int v = 0; v < 100; ++v) {
+        for (int k = 0; k < 10; ++k) {
+            cache.push(k, std::make_shared<int>(v));
+        }
+    }
+    ASSERT_EQ(10U, cache.dirty_count());
+    ASSERT_EQ(10 * sizeof(int), cache.dirty_bytes());
+    ASSERT_EQ(0U, store.writes());
+
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, cache.get(3, tmp));
+    ASSERT_EQ(99, *tmp);
+
+    ASSERT_TRUE(cache.flush());
+    ASSERT_EQ(10U, store.writes());
+    ASSERT_EQ(0U, cache.dirty_count());
+    for (int k = 0; k < 10; ++k) {
+        ASSERT_EQ(99, store.value(k));
+    }
+
+    // 没有脏数据时flush不写入
+    ASSERT_TRUE(cache.flush());
+    ASSERT_EQ(10U, store.writes());
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheBatch) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(), {kNever, 0, 4, 0});
+    for (int k = 0; k < 10; ++k) {
+        cache.push(k, std::make_shared<int>(k));
+    }
+    ASSERT_TRUE(cache.flush());
+    ASSERT_EQ(10U, store.writes());
+    ASSERT_EQ(3U, store.m_batches);
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheThreshold) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(), {kNever, 8 * sizeof(int), 64, 0});
+
+    for (int k = 0; k < 7; ++k) {
+        cache.push(k, std::make_shared<int>(k));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(0U, store.writes());
+
+    // 脏数据达到阈值后由后台线程写回
+    cache.push(7, std::make_shared<int>(7));
+    ASSERT_TRUE(wait_for([&]() { return store.writes() == 8; }));
+    ASSERT_TRUE(wait_for([&]() { return cache.dirty_count() == 0; }));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheInterval) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(),
+                                     {std::chrono::milliseconds(5), 0, 64, 0});
+    cache.push(1, std::make_shared<int>(1));
+    ASSERT_TRUE(wait_for([&]() { return store.value(1) == 1; }));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheEvict) {
+    fake_store store;
+    write_back_cache<int, int> cache(10, 0, store.writer(), {kNever, 0, 64, 20});
+
+    for (int k = 0; k < 10; ++k) {
+        cache.push(k, std::make_shared<int>(k));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(0U, store.writes());
+
+    // 写回失败时，被淘汰的脏数据仍可读到
+    store.m_fail = true;
+    cache.push(10, std::make_shared<int>(10));
+    ASSERT_EQ(10U, cache.cache().size());
+    auto tmp = std::make_shared<int>(-1);
+    ASSERT_EQ(1, cache.get(0, tmp));
+    ASSERT_EQ(0, *tmp);
+
+    // 淘汰脏数据时触发写回
+    store.m_fail = false;
+    cache.push(11, std::make_shared<int>(11));
+    ASSERT_TRUE(wait_for([&]() { return store.value(0) == 0; }));
+    ASSERT_TRUE(wait_for([&]() { return cache.dirty_count() == 0; }));
+    ASSERT_EQ(0, cache.get(0, tmp));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheFailure) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(), {kNever, 0, 64, 0});
+    cache.push(1, std::make_shared<int>(1));
+
+    // 写入失败时数据保持为脏
+    store.m_fail = true;
+    ASSERT_FALSE(cache.flush());
+    ASSERT_EQ(1U, cache.dirty_count());
+
+    store.m_fail = false;
+    ASSERT_TRUE(cache.flush());
+    ASSERT_EQ(0U, cache.dirty_count());
+    ASSERT_EQ(1, store.value(1));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheDirtyLimit) {
+    fake_store store;
+    write_back_cache<int, int> cache(4, 0, store.writer(), {kNever, 0, 64, 8});
+
+    // 后端持续失败时，脏数据表不超过上限
+    store.m_fail = true;
+    for (int k = 0; k < 8; ++k) {
+        ASSERT_TRUE(cache.try_push(k, std::make_shared<int>(k)));
+    }
+    ASSERT_FALSE(cache.try_push(8, std::make_shared<int>(8)));
+    ASSERT_EQ(8U, cache.dirty_count());
+
+    // 已为脏的key可以合并更新
+    ASSERT_TRUE(cache.try_push(0, std::make_shared<int>(100)));
+    ASSERT_EQ(8U, cache.dirty_count());
+
+    // push等待后端恢复后写回腾出的空间
+    std::atomic<bool> pushed(false);
+    std::thread pusher([&]() {
+        cache.push(8, std::make_shared<int>(8));
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(pushed.load());
+
+    store.m_fail = false;
+    pusher.join();
+    ASSERT_TRUE(cache.flush());
+    ASSERT_EQ(100, store.value(0));
+    ASSERT_EQ(8, store.value(8));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheRetry) {
+    fake_store store;
+    write_back_cache<int, int> cache(4, 0, store.writer(), {kNever, 0, 64, 4});
+
+    // 写回失败后即使没有新的请求也会重试，不需要等待下一个定时间隔
+    store.m_fail = true;
+    for (int k = 0; k < 4; ++k) {
+        ASSERT_TRUE(cache.try_push(k, std::make_shared<int>(k)));
+    }
+    std::atomic<bool> pushed(false);
+    std::thread pusher([&]() {
+        cache.push(4, std::make_shared<int>(4));
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_FALSE(pushed.load());
+
+    store.m_fail = false;
+    bool unblocked = wait_for([&]() { return pushed.load(); });
+    cache.close();
+    pusher.join();
+    ASSERT_TRUE(unblocked);
+    ASSERT_EQ(4, store.value(4));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheZeroInterval) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(),
+                                     {std::chrono::milliseconds(0), 0, 64, 0});
+    cache.push(1, std::make_shared<int>(1));
+    ASSERT_TRUE(wait_for([&]() { return store.value(1) == 1; }));
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheConcurrentSameKey) {
+    fake_store store;
+    write_back_cache<int, int> cache(100, 0, store.writer(), {kNever, 0, 64, 0});
+
+    // 多个线程并发更新同一个key，缓存中的值与写回后端的值一致
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&cache, round, t]() {
+                cache.push(0, std::make_shared<int>(round * 4 + t));
+            });
+        }
+        for (auto& w : writers) {
+            w.join();
+        }
+        ASSERT_TRUE(cache.flush());
+
+        auto tmp = std::make_shared<int>(-1);
+        ASSERT_EQ(1, cache.get(0, tmp));
+        ASSERT_EQ(store.value(0), *tmp);
+    }
+}
+
+TEST(WriteBackCacheTest, WriteBackCacheDurability) {
+    fake_store store;
+    const int n = 20000;
+    {
+        // 后台线程频繁写回的同时持续更新，close后最终值全部落盘且同一key不会被旧值覆盖
+        write_back_cache<int, int> cache(64, 0, store.writer(),
+                                         {std::chrono::milliseconds(1), 16 * sizeof(int), 8, 0});
+        for (int i = 0; i < n; ++i) {
+            cache.push(i % 100, std::make_shared<int>(i));
+        }
+        ASSERT_TRUE(cache.close());
+        ASSERT_EQ(0U, cache.dirty_count());
+    }
+
+    ASSERT_TRUE(store.m_ordered);
+    for (int k = 0; k < 100; ++k) {
+        ASSERT_EQ(n - 100 + k, store.value(k));
+    }
+    ASSERT_GT(static_cast<size_t >(n), store.writes());
+}
+
+}// namespace base
+}// namespace tinycommon
+
+int main(int argc,char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);//将命令行参数传递给gtest
+    return RUN_ALL_TESTS();   //RUN_ALL_TESTS()运行所有测试案例
+}
@@ -0,0 +1,162 @@
+#ifndef COMMON_BASE_WINDOWED_RATE_H
+#define COMMON_BASE_WINDOWED_RATE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 基于累计计数快照的滑动窗口比率（如最近一段时间的命中率）
+/// \details 计数方只维护累计的分子、分母，不感知时间窗口；读取方在每个时间桶内记录一次累计值的快照，
+///          窗口比率为当前累计值与窗口起点快照之差的比值，因此计数方没有额外开销；
+///          快照以seqlock方式读写，读取方之间只用try_lock竞争记录快照的权利，不会等待
+/// \param [Buckets] 时间桶个数，窗口精度为 Window / Buckets
+/// \warning 快照只在读取时记录，长时间没有读取后的第一次读取覆盖的时间可能大于窗口
+///
+template <size_t Buckets = 16>
+class windowed_rate
+{
+public:
+    using count_type        = uint64_t;
+    using rate_type         = double;
+
+    static_assert(Buckets >= 2, "windowed_rate requires at least 2 buckets");
+
+private:
+    struct snapshot {
+        std::atomic<uint32_t>   m_version;  // 奇数表示正在写入
+        std::atomic<int64_t>    m_tick;     // 时间桶序号，-1表示无效
+        std::atomic<count_type> m_num;
+        std::atomic<count_type> m_den;
+        std::atomic<uint64_t>   m_generation;   // 记录时计数所属的代
+    };
+
+    snapshot                    m_slots[Buckets];
+    std::atomic<int64_t>        m_bucket_ns;
+    std::mutex                  m_mutex;    // 只在读取方之间竞争，通过try_lock获取
+
+public:
+    ///
+    /// construct
+    /// \param [Window] 窗口长度
+    ///
+    explicit windowed_rate(std::chrono::nanoseconds Window = std::chrono::seconds(60))
+    {
+        set_window(Window);
+    }
+
+    windowed_rate(const windowed_rate&) = delete;
+    windowed_rate& operator=(const windowed_rate&) = delete;
+
+public:
+    ///
+    /// set_window
+    /// \brief 设置窗口长度，已记录的快照全部失效
+    ///
+    void set_window(std::chrono::nanoseconds Window)
+    {
+        std::lock_guard<std::mutex> lck (m_mutex);
+        int64_t bucket = static_cast<int64_t>(Window.count()) / static_cast<int64_t>(Buckets);
+        m_bucket_ns.store(bucket > 0 ? bucket : 1, std::memory_order_relaxed);
+        for (auto& slot : m_slots) {
+            slot.m_version.store(0, std::memory_order_relaxed);
+            slot.m_tick.store(-1, std::memory_order_relaxed);
+            slot.m_num.store(0, std::memory_order_relaxed);
+            slot.m_den.store(0, std::memory_order_relaxed);
+            slot.m_generation.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ///
+    /// update
+    /// \brief 传入当前的累计分子、分母，记录快照并返回窗口内的比率
+    /// \param [generation] 计数所属的代，计数被重置时由调用方递增，其他代的快照不参与计算
+    /// \return rate_type 窗口内分母没有增长时返回0
+    ///
+    rate_type update(count_type num, count_type den, uint64_t generation = 0)
+    {
+        int64_t bucket_ns = m_bucket_ns.load(std::memory_order_relaxed);
+        int64_t tick = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()) / bucket_ns;
+
+        snapshot& current = m_slots[tick % Buckets];
+        if (current.m_tick.load(std::memory_order_relaxed) != tick ||
+            current.m_generation.load(std::memory_order_relaxed) != generation) {
+            _record(current, tick, num, den, generation);
+        }
+
+        // 窗口起点：窗口内最旧的快照，窗口内没有更早的快照时退而使用窗口外最新的快照
+        int64_t oldest_tick = -1;
+        int64_t stale_tick = -1;
+        count_type base_num = num, base_den = den;
+        count_type stale_num = num, stale_den = den;
+        for (auto& slot : m_slots) {
+            int64_t t;
+            count_type n, d;
+            uint64_t g;
+            if (!_read(slot, t, n, d, g) || t < 0 || t >= tick || g != generation || n > num || d > den) {
+                // 无效、当前桶、或统计被重置之前的快照
+                continue;
+            }
+            if (t > tick - static_cast<int64_t>(Buckets)) {
+                if (oldest_tick < 0 || t < oldest_tick) {
+                    oldest_tick = t;
+                    base_num = n;
+                    base_den = d;
+                }
+            } else if (t > stale_tick) {
+                stale_tick = t;
+                stale_num = n;
+                stale_den = d;
+            }
+        }
+        if (oldest_tick < 0) {
+            base_num = stale_num;
+            base_den = stale_den;
+        }
+
+        count_type delta = den - base_den;
+        return delta == 0 ? 0.0 : static_cast<rate_type>(num - base_num) / static_cast<rate_type>(delta);
+    }
+
+private:
+    void _record(snapshot& slot, int64_t tick, count_type num, count_type den, uint64_t generation)
+    {
+        std::unique_lock<std::mutex> lck (m_mutex, std::try_to_lock);
+        if (!lck.owns_lock() || (slot.m_tick.load(std::memory_order_relaxed) == tick &&
+                                 slot.m_generation.load(std::memory_order_relaxed) == generation)) {
+            return;
+        }
+        uint32_t version = slot.m_version.load(std::memory_order_relaxed);
+        slot.m_version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_tick.store(tick, std::memory_order_relaxed);
+        slot.m_num.store(num, std::memory_order_relaxed);
+        slot.m_den.store(den, std::memory_order_relaxed);
+        slot.m_generation.store(generation, std::memory_order_relaxed);
+        slot.m_version.store(version + 2, std::memory_order_release);
+    }
+
+    static bool _read(const snapshot& slot, int64_t& tick, count_type& num, count_type& den, uint64_t& generation)
+    {
+        uint32_t before = slot.m_version.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        tick = slot.m_tick.load(std::memory_order_relaxed);
+        num = slot.m_num.load(std::memory_order_relaxed);
+        den = slot.m_den.load(std::memory_order_relaxed);
+        generation = slot.m_generation.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.m_version.load(std::memory_order_relaxed) == before;
+    }
+};
+
+} // namespace base
+} // namespace tinycommon
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef COMMON_BASE_WRITE_BACK_CACHE_H
+#define COMMON_BASE_WRITE_BACK_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lru_cache.h"
+
+namespace tinycommon {
+namespace base {
+
+///
+/// 写回（write-back）模式的LRU缓存
+/// \details push只更新缓存并将key标记为脏，同一key的多次更新合并为一次写入；
+///          脏数据由后台线程通过用户提供的batch_writer批量写回，触发条件为：
+///          定时、脏数据大小超过阈值、脏数据被LRU淘汰；
+///          被淘汰的脏数据在写回前仍保留在脏数据表中，get仍可读到，不会丢失；
+///          脏数据表的大小有上限（Options::m_max_dirty），达到上限时push等待写回腾出空间，try_push直接返回失败，
+///          因此后端持续写入失败时内存占用不会无限增长；写回失败后间隔一段时间自动重试，
+///          期间有新的写回请求（如push等待空间）时提前重试
+/// \warning 同一key的写回按更新顺序进行，旧值不会覆盖新值；不同key之间按最后一次更新的顺序写回
+///
+template <typename Key, typename Value>
+class write_back_cache
+{
+public:
+    using key_type          = Key;
+    using value_type        = Value;
+    using cache_type        = LRU_cache<Key, Value>;
+    using value_ptr_type    = typename cache_type::value_ptr_type;
+    using size_type         = size_t;
+    using batch_type        = std::vector<std::pair<key_type, value_ptr_type>>;
+
+    ///
+    /// 批量写回后端
+    /// \return bool [true]: 写入成功 [false]: 写入失败，此批数据保持为脏，稍后重试
+    ///
+    using batch_writer      = std::function<bool(const batch_type&)>;
+
+    struct Options {
+        std::chrono::milliseconds   m_flush_interval;   // 定时写回的间隔，小于1ms时取1ms
+        size_type                   m_dirty_bytes;      // 脏数据超过此大小（以字节为单位）时立即写回，为0时不限制
+        size_type                   m_max_batch;        // 每批最多写回的元素个数
+        size_type                   m_max_dirty;        // 脏数据表最多保留的key个数，为0时取缓存容量的2倍
+    };
+
+private:
+    using sequence_type     = uint64_t;
+
+    struct dirty_entry {
+        value_ptr_type  m_value;
+        sequence_type   m_seq;      // 最后一次更新的序号
+    };
+
+    cache_type                                  m_cache;
+    batch_writer                                m_writer;
+    Options                                     m_options;
+
+    // 脏数据表，m_order按最后一次更新的顺序索引
+    mutable std::mutex                          m_dirty_mutex;
+    std::condition_variable                     m_dirty_cond;       // 写回腾出空间时唤醒等待的push
+    std::unordered_map<key_type, dirty_entry>   m_dirty;
+    std::map<sequence_type, key_type>           m_order;
+    sequence_type                               m_seq;
+    std::atomic<size_type>                      m_dirty_count;      // m_dirty.size()，供淘汰回调无锁读取
+
+    // 串行化写回，保证同一key的写回顺序
+    std::mutex                                  m_flush_mutex;
+
+    // 后台线程
+    std::mutex                                  m_thread_mutex;
+    std::condition_variable                     m_thread_cond;
+    std::thread                                 m_thread;
+    bool                                        m_running;
+    bool                                        m_flush_requested;
+
+public:
+    write_back_cache() = delete;
+    write_back_cache(const write_back_cache&) = delete;
+    write_back_cache& operator=(const write_back_cache&) = delete;
+
+    ///
+    /// construct
+    /// \param [Size] 最大元素个数，[MemorySize] 最大内存大小（以字节为单位，为0时不限制），
+    ///        [writer] 批量写回后端，[options] 写回参数
+    /// \details 构造后即启动后台写回线程
+    ///
+    write_back_cache(size_type Size, size_type MemorySize, const batch_writer& writer, const Options& options);
+
+    ~write_back_cache()
+    {
+        close();
+    }
+
+public:
+    ///
+    /// push
+    /// \brief 将k-v对压入缓存并标记为脏，不立即写回
+    /// \warning 脏数据表已满且key不在其中时，等待后台线程写回腾出空间；close之后不再等待
+    ///
+    void push(const key_type& key, const value_ptr_type& value)
+    {
+        _push(key, value, true);
+    }
+
+    ///
+    /// try_push
+    /// \brief 与push相同，但脏数据表已满且key不在其中时不等待
+    /// \return bool [true]: 压入成功 [false]: 脏数据表已满，未压入
+    ///
+    bool try_push(const key_type& key, const value_ptr_type& value)
+    {
+        return _push(key, value, false);
+    }
+
+    ///
+    /// get
+    /// \brief 根据key取出value，缓存中已淘汰但尚未写回的脏数据也能取到
+    /// \return bool [ture]: 有此k-v对 [false]: 无此k-v对
+    ///
+    bool get(const key_type& key, value_ptr_type& value);
+
+    ///
+    /// flush
+    /// \brief 同步写回调用前的所有脏数据
+    /// \return bool [true]: 全部写回成功 [false]: batch_writer返回失败
+    ///
+    bool flush();
+
+    ///
+    /// close
+    /// \brief 停止后台线程并写回所有脏数据，之后push的数据只能通过flush写回
+    /// \return bool 同flush
+    ///
+    bool close();
+
+    ///
+    /// dirty_count
+    /// \return size_type 尚未写回的key个数
+    ///
+    size_type dirty_count() const
+    {
+        std::lock_guard<std::mutex> lck (m_dirty_mutex);
+        return m_dirty.size();
+    }
+
+    ///
+    /// dirty_bytes
+    /// \return size_type 尚未写回的数据大小（与LRU_cache相同，按sizeof(Value)计算）
+    ///
+    size_type dirty_bytes() const
+    {
+        return dirty_count() * sizeof(value_type);
+    }
+
+    ///
+    /// cache
+    /// \brief 内部的LRU缓存，可用于获取命中率等统计信息
+    ///
+    const cache_type& cache() const
+    {
+        return m_cache;
+    }
+
+private:
+    ///
+    /// [内部方法] 标记为脏并更新缓存，两者在同一个临界区内完成
+    /// \param [wait] 脏数据表已满时是否等待
+    /// \return bool [true]: 压入成功 [false]: 脏数据表已满且不等待
+    ///
+    bool _push(const key_type& key, const value_ptr_type& value, bool wait);
+
+    ///
+    /// [内部方法] 按更新顺序写回至多MaxBatch个脏数据，只写回序号不大于Target的数据
+    /// \param [out]: written 写回的元素个数
+    /// \return bool batch_writer的返回值，没有需要写回的数据时返回true
+    ///
+    bool _flush_batch(sequence_type Target, size_type& written);
+
+    ///
+    /// [内部方法] 唤醒后台线程写回
+    /// \return bool [true]: 后台线程在运行 [false]: 已close
+    ///
+    bool _request_flush()
+    {
+        bool running;
+        {
+            std::lock_guard<std::mutex> lck (m_thread_mutex);
+            m_flush_requested = true;
+            running = m_running;
+        }
+        m_thread_cond.notify_one();
+        return running;
+    }
+
+    void _run();
+};
+
+template <typename Key, typename Value>
+write_back_cache<Key, Value>::write_back_cache(size_type Size, size_type MemorySize,
+                                               const batch_writer& writer, const Options& options) :
+    m_cache(Size, MemorySize),
+    m_writer(writer),
+    m_options(options),
+    m_seq(0),
+    m_dirty_count(0),
+    m_running(true),
+    m_flush_requested(false)
+{
+    if (m_options.m_flush_interval < std::chrono::milliseconds(1)) {
+        // 间隔为0时后台线程会空转
+        m_options.m_flush_interval = std::chrono::milliseconds(1);
+    }
+    if (m_options.m_max_batch == 0) {
+        m_options.m_max_batch = 1;
+    }
+    if (m_options.m_max_dirty == 0) {
+        // 默认允许在缓存之外再保留一个缓存容量的已淘汰脏数据
+        size_type capacity = Size;
+        if (MemorySize != 0) {
+            capacity = std::min(capacity, std::max<size_type>(MemorySize / sizeof(value_type), 1));
+        }
+        m_options.m_max_dirty = capacity * 2;
+    }
+
+    // 回调在LRU_cache的锁内调用，而push在脏数据表的锁内更新LRU_cache，
+    // 因此回调不能获取脏数据表的锁，只要有脏数据就唤醒后台线程。加锁顺序为 脏数据表 -> LRU_cache -> 后台线程
+    m_cache.set_discard_callback([this](const key_type&, const value_ptr_type&) {
+        if (m_dirty_count.load(std::memory_order_relaxed) != 0) {
+            _request_flush();
+        }
+    });
+
+    m_thread = std::thread(&write_back_cache::_run, this);
+}
+
+template <typename Key, typename Value>
+bool write_back_cache<Key, Value>::_push(const key_type& key, const value_ptr_type& value, bool wait)
+{
+    bool over_threshold = false;
+    {
+        std::unique_lock<std::mutex> lck (m_dirty_mutex);
+        auto ite = m_dirty.find(key);
+
+        // 脏数据表已满时等待写回腾出空间，合并到已有脏数据的更新不占用新空间
+        while (ite == m_dirty.end() && m_dirty.size() >= m_options.m_max_dirty) {
+            bool running = _request_flush();
+            if (!wait) {
+                return false;
+            }
+            if (!running) {
+                break;
+            }
+            m_dirty_cond.wait(lck);
+            ite = m_dirty.find(key);
+        }
+
+        sequence_type seq = ++m_seq;
+        if (ite == m_dirty.end()) {
+            m_dirty[key] = dirty_entry{value, seq};
+            m_dirty_count.store(m_dirty.size(), std::memory_order_relaxed);
+        } else {
+            // 合并：只保留最新的值，顺序按最后一次更新计算
+            m_order.erase(ite->second.m_seq);
+            ite->second.m_value = value;
+            ite->second.m_seq = seq;
+        }
+        m_order[seq] = key;
+
+        // 在同一临界区内更新缓存，并发push同一key时缓存与脏数据表保留的是同一个最新值
+        m_cache.push(key, value);
+
+        over_threshold = m_options.m_dirty_bytes != 0 &&
+            m_dirty.size() * sizeof(value_type) >= m_options.m_dirty_bytes;
+    }
+
+    if (over_threshold) {
+        _request_flush();
+    }
+    return true;
+}
+
+template <typename Key, typename Value>
+bool write_back_cache<Key, Value>::get(const key_type& key, value_ptr_type& value)
+{
+    if (m_cache.get(key, value)) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lck (m_dirty_mutex);
+    auto ite = m_dirty.find(key);
+    if (ite == m_dirty.end()) {
+        return false;
+    }
+    value = ite->second.m_value;
+    return true;
+}
+
+template <typename Key, typename Value>
+bool write_back_cache<Key, Value>::flush()
+{
+    sequence_type target;
+    {
+        std::lock_guard<std::mutex> lck (m_dirty_mutex);
+        target = m_seq;
+    }
+
+    size_type written = 0;
+    do {
+        if (!_flush_batch(target, written)) {
+            return false;
+        }
+    } while (written != 0);
+    return true;
+}
+
+template <typename Key, typename Value>
+bool write_back_cache<Key, Value>::close()
+{
+    {
+        std::lock_guard<std::mutex> lck (m_thread_mutex);
+        m_running = false;
+    }
+    m_thread_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    return flush();
+}
+
+template <typename Key, typename Value>
+bool write_back_cache<Key, Value>::_flush_batch(sequence_type Target, size_type& written)
+{
+    written = 0;
+    std::lock_guard<std::mutex> flush_lck (m_flush_mutex);
+
+    // 取出一批，写回期间仍保留在脏数据表中，get可以读到
+    batch_type batch;
+    std::vector<sequence_type> seqs;
+    {
+        std::lock_guard<std::mutex> lck (m_dirty_mutex);
+        for (auto ite = m_order.begin();
+             ite != m_order.end() && ite->first <= Target && batch.size() < m_options.m_max_batch;
+             ++ite) {
+            batch.push_back(std::make_pair(ite->second, m_dirty[ite->second].m_value));
+            seqs.push_back(ite->first);
+        }
+    }
+
+    if (batch.empty()) {
+        return true;
+    }
+
+    // 写回时不持有脏数据表的锁，不阻塞push/get
+    if (!m_writer(batch)) {
+        return false;
+    }
+
+    // 写回期间被再次更新的key仍为脏
+    {
+        std::lock_guard<std::mutex> lck (m_dirty_mutex);
+        for (size_type i = 0; i < batch.size(); ++i) {
+            auto ite = m_dirty.find(batch[i].first);
+            if (ite != m_dirty.end() && ite->second.m_seq == seqs[i]) {
+                m_order.erase(seqs[i]);
+                m_dirty.erase(ite);
+            }
+        }
+        m_dirty_count.store(m_dirty.size(), std::memory_order_relaxed);
+    }
+    m_dirty_cond.notify_all();
+    written = batch.size();
+    return true;
+}
+
+template <typename Key, typename Value>
+void write_back_cache<Key, Value>::_run()
+{
+    // 写回失败后的重试间隔
+    const std::chrono::milliseconds retry_delay = std::min(m_options.m_flush_interval, std::chrono::milliseconds(100));
+
+    std::unique_lock<std::mutex> lck (m_thread_mutex);
+    while (m_running) {
+        m_thread_cond.wait_for(lck, m_options.m_flush_interval,
+                               [this]() { return !m_running || m_flush_requested; });
+        if (!m_running) {
+            break;
+        }
+        // 写回期间到达的请求重新置位，下一轮立即处理
+        m_flush_requested = false;
+
+        lck.unlock();
+        bool ok = flush();
+        bool full = m_dirty_count.load(std::memory_order_relaxed) >= m_options.m_max_dirty;
+        lck.lock();
+
+        if (!ok) {
+            // 失败的数据仍为脏，无论是否有新的请求都需重试，否则等待空间的push可能一直阻塞
+            m_thread_cond.wait_for(lck, retry_delay,
+                                   [this]() { return !m_running || m_flush_requested; });
+            m_flush_requested = true;
+        } else if (full) {
+            // 写回期间又写满了，等待空间的push需要再写回一次
+            m_flush_requested = true;
+        }
+    }
+}
+
+} // namespace base
+} // namespace tinycommon
+
+#endif